@@ -0,0 +1,130 @@
+#include "alphabet.h"
+#include <fstream>
+
+namespace Dictionary
+{
+    // Decode UTF-8 character at position, return its code point and advance position. Return
+    // nullopt for invalid sequence.
+    std::optional<uint32_t> DecodeCharacter(std::string_view text, size_t& position)
+    {
+        auto first = (uint8_t)text[position];
+        size_t size = first < 0x80 ? 1 : (first >> 5) == 0x6 ? 2 : (first >> 4) == 0xe ? 3 : (first >> 3) == 0x1e ? 4 : 0;
+
+        if (size == 0 || position + size > text.size())
+            return std::nullopt;
+
+        uint32_t result = size == 1 ? first : first & (0x7f >> size);
+        for (size_t i = 1; i < size; ++i)
+        {
+            auto next = (uint8_t)text[position + i];
+            if ((next >> 6) != 0x2)
+                return std::nullopt;
+
+            result = (result << 6) | (next & 0x3f);
+        }
+
+        position += size;
+        return result;
+    }
+
+    bool Alphabet::AddLetters(std::string_view text)
+    {
+        std::vector<std::pair<uint32_t, std::string_view>> added;
+
+        for (size_t position = 0; position < text.size();)
+        {
+            size_t start = position;
+            auto character = DecodeCharacter(text, position);
+            if (!character)
+                return false;
+
+            bool known = m_codes.count(*character) != 0;
+            for (const auto& letter : added)
+                known = known || letter.first == *character;
+
+            if (!known)
+                added.push_back({ *character, text.substr(start, position - start) });
+        }
+
+        if (m_letters.size() + added.size() > MAX_SIZE)
+            return false;
+
+        for (const auto& [character, letter] : added)
+        {
+            m_letters.emplace_back(letter);
+            m_codes[character] = (uint8_t)m_letters.size();
+        }
+
+        return true;
+    }
+
+    std::optional<std::string> Alphabet::Encode(std::string_view text) const
+    {
+        std::string result;
+
+        for (size_t position = 0; position < text.size();)
+        {
+            auto character = DecodeCharacter(text, position);
+            if (!character)
+                return std::nullopt;
+
+            auto code = m_codes.find(*character);
+            if (code == std::end(m_codes))
+                return std::nullopt;
+
+            result.push_back((char)code->second);
+        }
+
+        return result;
+    }
+
+    std::string Alphabet::Decode(std::string_view codes, char empty) const
+    {
+        std::string result;
+
+        for (auto code : codes)
+        {
+            if (code == 0)
+                result.push_back(empty);
+            else if (!IsLetter((uint8_t)code))
+                result.push_back(INVALID_LETTER);
+            else
+                result.append(GetLetter((uint8_t)code));
+        }
+
+        return result;
+    }
+
+    // Number of characters of UTF-8 text, nullopt if it is not valid UTF-8.
+    std::optional<size_t> CountCharacters(std::string_view text)
+    {
+        size_t result = 0;
+
+        for (size_t position = 0; position < text.size(); ++result)
+        {
+            if (!DecodeCharacter(text, position))
+                return std::nullopt;
+        }
+
+        return result;
+    }
+
+    Data ReadDictionary(const std::string& path, Alphabet& alphabet)
+    {
+        Data result;
+        std::ifstream file(path);
+        std::string word;
+
+        while (file >> word)
+        {
+            // size is checked first, so letters of skipped words do not take codes
+            auto size = CountCharacters(word);
+            if (!size || *size >= result.size() || !alphabet.AddLetters(word))
+                continue;
+
+            result[*size].Add(*alphabet.Encode(word));
+        }
+
+        return result;
+    }
+}
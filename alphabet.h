@@ -0,0 +1,47 @@
+#pragma once
+#include <string>
+#include <string_view>
+#include <vector>
+#include <unordered_map>
+#include <optional>
+#include <cstdint>
+#include "dictionary.h"
+
+namespace Dictionary
+{
+    // Letters of one language (UTF-8 characters) mapped to dense codes 1 - Size(), 0 stays empty
+    // cell. Encoded words and boards have one byte per letter, so word size is its letter count
+    // and set of letters fits into one 64 bit mask.
+    class Alphabet
+    {
+    public:
+        static constexpr size_t MAX_SIZE = 63;
+
+        // Add all characters of UTF-8 text. Return false if text is not valid UTF-8 or alphabet
+        // would exceed MAX_SIZE, in which case alphabet is not changed.
+        bool AddLetters(std::string_view text);
+
+        // Decoded code which is not in alphabet.
+        static constexpr char INVALID_LETTER = '?';
+
+        size_t Size() const { return m_letters.size(); }
+        bool IsLetter(uint8_t code) const { return code != 0 && code <= m_letters.size(); }
+        // UTF-8 character of code from [1, Size()], empty for other codes.
+        const std::string& GetLetter(uint8_t code) const { return IsLetter(code) ? m_letters[code - 1] : m_none; }
+
+        // Return nullopt if text contains character not in alphabet.
+        std::optional<std::string> Encode(std::string_view text) const;
+        // Empty cells are decoded as empty, codes not in alphabet as INVALID_LETTER.
+        std::string Decode(std::string_view codes, char empty = '.') const;
+
+    private:
+        std::vector<std::string> m_letters;
+        std::unordered_map<uint32_t, uint8_t> m_codes;
+        std::string m_none;
+    };
+
+    // Read UTF-8 dictionary, its letters are added to alphabet and words are stored encoded, so
+    // they are bucketed by letter count. Words which don't fit into alphabet or are too long are
+    // skipped, their letters are added only if they are used by other words.
+    Data ReadDictionary(const std::string& path, Alphabet& alphabet);
+}
@@ -0,0 +1,101 @@
+#include "automaton.h"
+#include <queue>
+#include <algorithm>
+
+namespace WordSearch
+{
+    WordAutomaton::WordAutomaton(const std::vector<std::string_view>& words)
+    {
+        // dense symbols for characters used by words, 0 is reserved for everything else
+        for (const auto& word : words)
+        {
+            for (auto character : word)
+            {
+                if (m_symbols[(uint8_t)character] == 0)
+                    m_symbols[(uint8_t)character] = (uint8_t)m_symbolCount++;
+            }
+        }
+
+        // trie (0 as transition means missing child, root is never a child)
+        m_transitions.assign(m_symbolCount, 0);
+        std::vector<std::vector<uint32_t>> outputs(1);
+
+        for (size_t i = 0; i < words.size(); ++i)
+        {
+            m_wordSizes.push_back(words[i].size());
+
+            AddPattern(words[i], false, (uint32_t)i, outputs);
+            AddPattern(words[i], true, (uint32_t)i, outputs);
+        }
+
+        // failure links compiled directly into transitions, outputs merged along failure links
+        size_t nodeCount = outputs.size();
+        std::vector<State> fail(nodeCount, 0);
+        std::queue<State> queue;
+
+        for (size_t symbol = 1; symbol < m_symbolCount; ++symbol)
+        {
+            if (auto child = m_transitions[symbol])
+                queue.push(child);
+        }
+
+        while (!queue.empty())
+        {
+            State node = queue.front();
+            queue.pop();
+
+            for (size_t symbol = 1; symbol < m_symbolCount; ++symbol)
+            {
+                State& child = m_transitions[node * m_symbolCount + symbol];
+                State fallback = m_transitions[fail[node] * m_symbolCount + symbol];
+
+                if (child == 0)
+                {
+                    child = fallback;
+                    continue;
+                }
+
+                fail[child] = fallback;
+                outputs[child].insert(std::end(outputs[child]), std::begin(outputs[fallback]), std::end(outputs[fallback]));
+                queue.push(child);
+            }
+        }
+
+        m_outputStarts.reserve(nodeCount + 1);
+        for (const auto& output : outputs)
+        {
+            m_outputStarts.push_back((uint32_t)m_outputs.size());
+
+            for (auto pattern : output)
+            {
+                m_outputs.push_back(pattern / 2);
+                m_outputReversed.push_back((uint8_t)(pattern % 2));
+            }
+        }
+        m_outputStarts.push_back((uint32_t)m_outputs.size());
+    }
+
+    void WordAutomaton::AddPattern(std::string_view word, bool reversed, uint32_t index, std::vector<std::vector<uint32_t>>& outputs)
+    {
+        State node = 0;
+
+        for (size_t i = 0; i < word.size(); ++i)
+        {
+            auto character = reversed ? word[word.size() - 1 - i] : word[i];
+
+            State& child = m_transitions[node * m_symbolCount + m_symbols[(uint8_t)character]];
+
+            if (child == 0)
+            {
+                child = (State)outputs.size();
+                outputs.emplace_back();
+                // child reference is invalidated by resize, it is read again below
+                m_transitions.resize(m_transitions.size() + m_symbolCount, 0);
+            }
+
+            node = m_transitions[node * m_symbolCount + m_symbols[(uint8_t)character]];
+        }
+
+        outputs[node].push_back(index * 2 + (reversed ? 1 : 0));
+    }
+}
@@ -0,0 +1,66 @@
+#pragma once
+#include <vector>
+#include <array>
+#include <string_view>
+#include <cstdint>
+#include "board.h"
+
+namespace WordSearch
+{
+    // Aho-Corasick automaton over words and their reversals. Scanning a board line in one
+    // direction therefore finds occurrences written in both directions. Palindrome matches
+    // both of its patterns, so each of its occurrences is reported twice.
+    class WordAutomaton
+    {
+    public:
+        using State = uint32_t;
+
+        WordAutomaton() = default;
+        explicit WordAutomaton(const std::vector<std::string_view>& words);
+
+        size_t WordCount() const { return m_wordSizes.size(); }
+        size_t WordSize(size_t word) const { return m_wordSizes[word]; }
+
+        // Empty cell (0) and characters not present in any word lead back to root.
+        State Next(State state, uint8_t character) const { return m_transitions[state * m_symbolCount + m_symbols[character]]; }
+
+        // Words which occurrence ends in state.
+        const uint32_t* MatchesBegin(State state) const { return m_outputs.data() + m_outputStarts[state]; }
+        const uint32_t* MatchesEnd(State state) const { return m_outputs.data() + m_outputStarts[state + 1]; }
+        // Check if match (from MatchesBegin - MatchesEnd) is occurrence of reversed word.
+        bool IsReversed(const uint32_t* match) const { return m_outputReversed[match - m_outputs.data()] != 0; }
+
+        // Call function(word, position) for each occurrence ending on position of line.
+        template<class T>
+        void Scan(const uint8_t* cells, const Line& line, T function) const
+        {
+            if (m_wordSizes.empty())
+                return;
+
+            State state = 0;
+            ptrdiff_t index = (ptrdiff_t)line.start;
+
+            for (size_t i = 0; i < line.length; ++i, index += line.stride)
+            {
+                state = Next(state, cells[index]);
+
+                for (auto it = MatchesBegin(state); it != MatchesEnd(state); ++it)
+                    function(*it, i);
+            }
+        }
+
+    private:
+        // outputs are collected as patterns (word * 2 + reversed)
+        void AddPattern(std::string_view word, bool reversed, uint32_t index, std::vector<std::vector<uint32_t>>& outputs);
+
+        std::array<uint8_t, 256> m_symbols{};
+        size_t m_symbolCount = 1;
+
+        std::vector<State> m_transitions;
+        std::vector<uint32_t> m_outputStarts;
+        std::vector<uint32_t> m_outputs;
+        std::vector<uint8_t> m_outputReversed;
+
+        std::vector<size_t> m_wordSizes;
+    };
+}
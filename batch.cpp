@@ -0,0 +1,39 @@
+#include "batch.h"
+#include "parallel.h"
+
+namespace WordSearch
+{
+    Puzzle GeneratePuzzle(const Dictionary::Data& data, uint64_t seed, const BatchOptions& options)
+    {
+        Random::Generator generator(seed);
+
+        auto [board, words] = PositionWords(generator, data, options.rows, options.cols, options.wordSizeFrom, options.wordSizeTo, options.policy);
+
+        if (options.fill)
+            FillFreeCellsRandom(generator, board, words, options.letters ? *options.letters : GetLetterDistribution(data));
+
+        return { seed, std::move(board), std::move(words) };
+    }
+
+    std::vector<Puzzle> GeneratePuzzles(const Dictionary::Data& data, size_t count, const BatchOptions& options)
+    {
+        std::vector<Puzzle> result(count);
+        uint64_t seed = options.seed ? *options.seed : Random::GetRandomSeed();
+
+        // letters are counted once for all puzzles
+        LetterDistribution letters;
+        BatchOptions puzzleOptions = options;
+        if (options.fill && !options.letters)
+        {
+            letters = GetLetterDistribution(data);
+            puzzleOptions.letters = &letters;
+        }
+
+        ParallelFor(count, options.threadCount, [&](size_t i)
+            {
+                result[i] = GeneratePuzzle(data, Random::DeriveSeed(seed, i), puzzleOptions);
+            });
+
+        return result;
+    }
+}
@@ -0,0 +1,41 @@
+#pragma once
+#include <vector>
+#include <optional>
+#include "wordSearch.h"
+
+namespace WordSearch
+{
+    struct BatchOptions
+    {
+        size_t rows = 10;
+        size_t cols = 10;
+        size_t wordSizeFrom = Dictionary::MIN_WORD_SIZE;
+        size_t wordSizeTo = Dictionary::MAX_WORD_SIZE;
+        PlacementPolicy policy;
+        // fill free cells with random letters
+        bool fill = true;
+        // letters of free cells, letters of dictionary (see GetLetterDistribution) if not set
+        const LetterDistribution* letters = nullptr;
+        // 0 means number of hardware threads
+        size_t threadCount = 0;
+        // seed of whole batch, random if not set
+        std::optional<uint64_t> seed;
+    };
+
+    struct Puzzle
+    {
+        // PositionWords (and FillFreeCellsRandom) with generator of this seed recreates the puzzle
+        uint64_t seed = 0;
+        Board board;
+        Words words;
+    };
+
+    // Generate one puzzle of options from seed, options.seed and threadCount are not used. Letters
+    // of dictionary are counted on each call if options.letters is not set.
+    Puzzle GeneratePuzzle(const Dictionary::Data& data, uint64_t seed, const BatchOptions& options);
+
+    // Generate count puzzles on a pool of threads. Dictionary is shared read-only by all threads
+    // and returned words point to it. Puzzle i is always at index i of result and it depends only
+    // on batch seed and i, not on number of threads.
+    std::vector<Puzzle> GeneratePuzzles(const Dictionary::Data& data, size_t count, const BatchOptions& options = {});
+}
@@ -0,0 +1,375 @@
+#include "wordSearch.h"
+#include "candidates.h"
+#include "dictionary.h"
+#include "dictionaryFile.h"
+#include "tiles.h"
+#include "serialize.h"
+#include "finder.h"
+#include "differential.h"
+#include "random.h"
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <iomanip>
+#include <algorithm>
+#include <string>
+#include <vector>
+
+namespace WordSearch
+{
+    Candidates GetCandidates(size_t rows, size_t cols);
+    bool IsAnyWordDuplicated(const Board& board, const Words& words, const Candidates& candidates);
+}
+
+namespace Benchmark
+{
+    using Clock = std::chrono::steady_clock;
+
+    // Results of one benchmark are comparable across commits only with same seed and dictionary.
+    static constexpr uint64_t SEED = 20191101;
+    static constexpr size_t WORDS_PER_SIZE = 4000;
+    static const char* DICTIONARY_PATH = "benchmark-dictionary.txt";
+    static const char* COMPILED_DICTIONARY_PATH = "benchmark-dictionary.bin";
+    static const char* OUTPUT_PATH = "benchmark-output.tmp";
+    static constexpr size_t OUTPUT_PUZZLES = 100000;
+
+    struct Range
+    {
+        size_t from;
+        size_t to;
+    };
+
+    static const size_t BOARD_SIZES[] = { 8, 10, 15, 20, 30, 50 };
+    static const size_t LARGE_BOARD_SIZES[] = { 100, 200 };
+    static const size_t TILE_SIZES[] = { 16, 32 };
+    static const Range WORD_SIZES[] = { { 3, 6 }, { 4, 10 }, { 3, Dictionary::MAX_WORD_SIZE } };
+
+    double ToMs(Clock::duration duration)
+    {
+        return std::chrono::duration<double, std::milli>(duration).count();
+    }
+
+    // Latencies of one measured operation.
+    class Samples
+    {
+    public:
+        void Add(Clock::duration duration) { m_values.push_back(ToMs(duration)); }
+
+        size_t Count() const { return m_values.size(); }
+        double Mean() const { return m_values.empty() ? 0 : Total() / m_values.size(); }
+        double Total() const
+        {
+            double result = 0;
+            for (auto value : m_values)
+                result += value;
+            return result;
+        }
+        double Percentile(double p)
+        {
+            if (m_values.empty())
+                return 0;
+
+            std::sort(std::begin(m_values), std::end(m_values));
+            return m_values[std::min(m_values.size() - 1, (size_t)(p * m_values.size()))];
+        }
+
+    private:
+        std::vector<double> m_values;
+    };
+
+    // Synthetic dictionary with english-like letter frequencies, same for every run.
+    void WriteDictionary(const std::string& path)
+    {
+        static const char LETTERS[] = "eeeeeeeeeeeetttttttttaaaaaaaaoooooooiiiiiiinnnnnnnsssssshhhhhhrrrrrrddddllllcccuuummwwffggyyppbbvkjxqz";
+
+        Random::Generator generator(SEED);
+        std::ofstream file(path);
+
+        for (size_t size = Dictionary::MIN_WORD_SIZE; size < Dictionary::MAX_WORD_SIZE; ++size)
+        {
+            // longer words are less common
+            size_t count = size <= 10 ? WORDS_PER_SIZE : WORDS_PER_SIZE * 10 / size;
+
+            for (size_t i = 0; i < count; ++i)
+            {
+                std::string word;
+                for (size_t j = 0; j < size; ++j)
+                    word.push_back(LETTERS[generator.Range(0, sizeof(LETTERS) - 2)]);
+
+                file << word << "\n";
+            }
+        }
+    }
+
+    template<class T>
+    Clock::duration Measure(T function)
+    {
+        auto start = Clock::now();
+        function();
+        return Clock::now() - start;
+    }
+
+    void Run(size_t minIterations, double minMs)
+    {
+        WriteDictionary(DICTIONARY_PATH);
+
+        Dictionary::Data data;
+        Samples load;
+        for (size_t i = 0; i < 5; ++i)
+            load.Add(Measure([&]() { data = Dictionary::ReadDictionary(DICTIONARY_PATH); }));
+
+        std::cout << std::fixed << std::setprecision(3);
+        std::cout << "dictionary load: p50 " << load.Percentile(0.5) << " ms\n";
+
+        Dictionary::WriteCompiledDictionary(data, COMPILED_DICTIONARY_PATH);
+        Samples mappedLoad;
+        for (size_t i = 0; i < 5; ++i)
+        {
+            Dictionary::MappedDictionary mapped;
+            mappedLoad.Add(Measure([&]() { mapped.Open(COMPILED_DICTIONARY_PATH); }));
+        }
+        std::remove(COMPILED_DICTIONARY_PATH);
+
+        std::cout << "compiled dictionary open: p50 " << mappedLoad.Percentile(0.5) << " ms\n\n";
+
+        std::cout << "board  candidate table (cold) ms  GetCandidates p50 ms\n";
+        for (auto size : BOARD_SIZES)
+        {
+            auto cold = Measure([&]() { WordSearch::GetCandidateTable(size, size); });
+
+            Samples candidates;
+            for (size_t i = 0; i < 5; ++i)
+                candidates.Add(Measure([&]() { WordSearch::GetCandidates(size, size); }));
+
+            std::cout << std::setw(5) << size << std::setw(30) << ToMs(cold) << std::setw(22) << candidates.Percentile(0.5) << "\n";
+        }
+        std::cout << "\n";
+
+        std::cout << "board  sizes    boards/s  position p50  position p99  fill p50  fill p99  words  free cells  unfilled  density\n";
+
+        for (auto size : BOARD_SIZES)
+        {
+            for (const auto& wordSizes : WORD_SIZES)
+            {
+                Random::Generator generator(SEED);
+                Samples position, fill;
+                size_t wordCount = 0, freeCells = 0, unfilled = 0;
+
+                while (position.Count() < minIterations || position.Total() + fill.Total() < minMs)
+                {
+                    WordSearch::Board board;
+                    WordSearch::Words words;
+
+                    position.Add(Measure([&]() { std::tie(board, words) = WordSearch::PositionWords(generator, data, size, size, wordSizes.from, wordSizes.to); }));
+
+                    wordCount += words.size();
+                    freeCells += WordSearch::GetFreeCellsCount(board);
+
+                    fill.Add(Measure([&]() { unfilled += WordSearch::FillFreeCellsRandom(generator, board, words).size(); }));
+                }
+
+                double count = (double)position.Count();
+                double cells = (double)(size * size);
+
+                std::cout << std::setw(5) << size
+                    << std::setw(4) << wordSizes.from << "-" << std::setw(2) << std::left << wordSizes.to << std::right
+                    << std::setw(12) << 1000.0 * count / (position.Total() + fill.Total())
+                    << std::setw(14) << position.Percentile(0.5) << std::setw(14) << position.Percentile(0.99)
+                    << std::setw(10) << fill.Percentile(0.5) << std::setw(10) << fill.Percentile(0.99)
+                    << std::setw(7) << std::setprecision(1) << wordCount / count
+                    << std::setw(12) << freeCells / count
+                    << std::setw(10) << unfilled / count
+                    << std::setw(9) << std::setprecision(3) << 1.0 - freeCells / count / cells << "\n";
+            }
+        }
+
+        std::cout << "\nboard  sizes  attempts  missing  repeated  present  exhausted      scanned      letters  no empty  duplicate  diagonal ms  straight ms\n";
+
+        for (auto size : BOARD_SIZES)
+        {
+            for (const auto& wordSizes : WORD_SIZES)
+            {
+                Random::Generator generator(SEED);
+                WordSearch::Stats stats;
+
+                for (size_t i = 0; i < minIterations; ++i)
+                    WordSearch::PositionWords(generator, data, size, size, wordSizes.from, wordSizes.to, {}, &stats);
+
+                // averages per board
+                auto average = [&](size_t value) { return (double)value / minIterations; };
+
+                std::cout << std::setw(5) << size
+                    << std::setw(4) << wordSizes.from << "-" << std::setw(2) << std::left << wordSizes.to << std::right << std::setprecision(1)
+                    << std::setw(10) << average(stats.attempts) << std::setw(9) << average(stats.missingWords)
+                    << std::setw(10) << average(stats.repeatedWords) << std::setw(9) << average(stats.presentWords)
+                    << std::setw(11) << average(stats.exhaustedCandidates) << std::setw(13) << average(stats.candidatesScanned)
+                    << std::setw(13) << average(stats.rejectedLetters) << std::setw(10) << average(stats.rejectedNoEmptyCell)
+                    << std::setw(11) << average(stats.rejectedDuplication) << std::setprecision(3)
+                    << std::setw(13) << ToMs(stats.diagonalTime) / minIterations << std::setw(13) << ToMs(stats.straightTime) / minIterations << "\n";
+            }
+        }
+
+        std::cout << "\nboard  policy      position p50  words  free cells  density  attempts  density/ms\n";
+
+        Dictionary::PatternIndex index(data);
+        WordSearch::PlacementPolicy policies[] = { {}, { WordSearch::Placement::Overlap, 1 }, { WordSearch::Placement::Overlap, 4 }, { WordSearch::Placement::Slot, 0, &index } };
+
+        for (auto size : BOARD_SIZES)
+        {
+            for (const auto& policy : policies)
+            {
+                Random::Generator generator(SEED);
+                WordSearch::Stats stats;
+                Samples position;
+                size_t wordCount = 0, freeCells = 0;
+
+                while (position.Count() < minIterations || position.Total() < minMs)
+                {
+                    WordSearch::Board board;
+                    WordSearch::Words words;
+
+                    position.Add(Measure([&]() { std::tie(board, words) = WordSearch::PositionWords(generator, data, size, size, Dictionary::MIN_WORD_SIZE, Dictionary::MAX_WORD_SIZE, policy, &stats); }));
+
+                    wordCount += words.size();
+                    freeCells += WordSearch::GetFreeCellsCount(board);
+                }
+
+                double count = (double)position.Count();
+                double density = 1.0 - freeCells / count / (double)(size * size);
+                std::string name = policy.placement == WordSearch::Placement::Random ? "random"
+                    : policy.placement == WordSearch::Placement::Slot ? "slot" : "overlap " + std::to_string(policy.topK);
+
+                std::cout << std::setw(5) << size << "  " << std::setw(10) << std::left << name << std::right << std::setprecision(3)
+                    << std::setw(14) << position.Percentile(0.5) << std::setprecision(1)
+                    << std::setw(7) << wordCount / count << std::setw(12) << freeCells / count << std::setprecision(3)
+                    << std::setw(9) << density << std::setw(10) << std::setprecision(0) << stats.attempts / count
+                    << std::setw(12) << std::setprecision(4) << density / position.Mean() << "\n";
+            }
+        }
+
+        std::cout << "\nboard  tile  position ms  fill ms  words  removed  free cells  density\n";
+
+        for (auto size : LARGE_BOARD_SIZES)
+        {
+            for (auto tileSize : TILE_SIZES)
+            {
+                Random::Generator generator(SEED);
+                WordSearch::TileOptions options;
+                options.tileSize = tileSize;
+                options.policy = { WordSearch::Placement::Slot, 0, &index };
+
+                WordSearch::Stats stats;
+                WordSearch::Board board;
+                WordSearch::Words words;
+
+                auto position = Measure([&]() { std::tie(board, words) = WordSearch::PositionWordsTiled(generator, data, size, size, options, &stats); });
+                size_t freeCells = WordSearch::GetFreeCellsCount(board);
+                auto fill = Measure([&]() { WordSearch::FillFreeCellsRandom(generator, board, words); });
+
+                std::cout << std::setw(5) << size << std::setw(6) << tileSize << std::setprecision(1)
+                    << std::setw(13) << ToMs(position) << std::setw(9) << ToMs(fill)
+                    << std::setw(7) << words.size() << std::setw(9) << stats.removedWords << std::setw(12) << freeCells
+                    << std::setw(9) << std::setprecision(3) << 1.0 - (double)freeCells / (size * size) << "\n";
+            }
+        }
+
+        std::cout << "\nformat       puzzles/s      MB/s\n";
+
+        Random::Generator outputGenerator(SEED);
+        std::vector<std::tuple<WordSearch::Board, WordSearch::Words>> outputPuzzles;
+        for (size_t i = 0; i < 100; ++i)
+        {
+            auto [board, words] = WordSearch::PositionWords(outputGenerator, data, 10, 10);
+            WordSearch::FillFreeCellsRandom(outputGenerator, board, words);
+            outputPuzzles.emplace_back(std::move(board), std::move(words));
+        }
+
+        auto reportOutput = [](const char* name, Clock::duration duration)
+        {
+            std::ifstream written(OUTPUT_PATH, std::ios::binary | std::ios::ate);
+            double seconds = ToMs(duration) / 1000;
+
+            std::cout << std::setw(6) << std::left << name << std::right << std::setprecision(0)
+                << std::setw(16) << OUTPUT_PUZZLES / seconds << std::setprecision(1)
+                << std::setw(10) << (double)written.tellg() / (1 << 20) / seconds << "\n";
+        };
+
+        // formatting of cell by cell stream output, as PrintBoard did
+        reportOutput("stream", Measure([&]()
+            {
+                std::ofstream file(OUTPUT_PATH, std::ios::binary);
+                for (size_t i = 0; i < OUTPUT_PUZZLES; ++i)
+                {
+                    const auto& [board, words] = outputPuzzles[i % outputPuzzles.size()];
+                    for (size_t r = 0; r < board.Rows(); ++r)
+                    {
+                        for (size_t c = 0; c < board.Cols(); ++c)
+                            file << std::setw(4) << (char)board.Get(r, c);
+                        file << "\n";
+                    }
+                    for (const auto& word : words)
+                        file << word << "\n";
+                }
+            }));
+
+        std::pair<const char*, WordSearch::Format> formats[] = { { "text", WordSearch::Format::Text }, { "json", WordSearch::Format::JsonLines }, { "binary", WordSearch::Format::Binary } };
+        for (const auto& [name, format] : formats)
+        {
+            reportOutput(name, Measure([&, format = format]()
+                {
+                    std::ofstream file(OUTPUT_PATH, std::ios::binary);
+                    WordSearch::PuzzleWriter writer(file, format);
+
+                    for (size_t i = 0; i < OUTPUT_PUZZLES; ++i)
+                    {
+                        const auto& [board, words] = outputPuzzles[i % outputPuzzles.size()];
+                        writer.Write(board, words);
+                    }
+                }));
+        }
+
+        std::remove(OUTPUT_PATH);
+
+        std::cout << "\nvalidation         puzzles/s\n";
+
+        size_t valid = 0;
+        auto candidates10 = WordSearch::GetCandidates(10, 10);
+        auto reference = Measure([&]()
+            {
+                for (size_t i = 0; i < OUTPUT_PUZZLES / 10; ++i)
+                {
+                    const auto& [board, words] = outputPuzzles[i % outputPuzzles.size()];
+                    valid += WordSearch::IsAnyWordDuplicated(board, words, candidates10) ? 0 : 1;
+                }
+            });
+        auto finder = Measure([&]()
+            {
+                for (size_t i = 0; i < OUTPUT_PUZZLES / 10; ++i)
+                {
+                    const auto& [board, words] = outputPuzzles[i % outputPuzzles.size()];
+                    valid += WordSearch::WordFinder(words).IsValid(board) ? 1 : 0;
+                }
+            });
+
+        std::cout << "reference 10x10" << std::setw(15) << std::setprecision(0) << OUTPUT_PUZZLES / 10 / (ToMs(reference) / 1000) << "\n";
+        std::cout << "finder 10x10   " << std::setw(15) << OUTPUT_PUZZLES / 10 / (ToMs(finder) / 1000) << "\n";
+        std::cout << "(" << valid << " of " << 2 * (OUTPUT_PUZZLES / 10) << " valid)\n";
+        std::remove(DICTIONARY_PATH);
+    }
+}
+
+// benchmark [minimal iterations] [minimal milliseconds per case]
+int main(int argc, char** argv)
+{
+    size_t minIterations = argc > 1 ? std::stoul(argv[1]) : 20;
+    double minMs = argc > 2 ? std::stod(argv[2]) : 1000;
+
+    Benchmark::Run(minIterations, minMs);
+
+    // fast kernels against their reference implementations, on the same random inputs
+    std::cout << "\n";
+    bool identical = Test::PrintDifferential(Test::RunDifferential(Benchmark::SEED, 100000), std::cout);
+
+    return identical ? 0 : 1;
+}
@@ -0,0 +1,102 @@
+#include "board.h"
+#include <algorithm>
+
+namespace WordSearch
+{
+    Board::Board(size_t rows, size_t cols)
+        : m_rows(rows), m_cols(cols), m_cells(rows * cols, 0)
+    {
+        ptrdiff_t row = (ptrdiff_t)cols;
+
+        m_strides[(size_t)Direction::Up] = -row;
+        m_strides[(size_t)Direction::Down] = row;
+        m_strides[(size_t)Direction::Left] = -1;
+        m_strides[(size_t)Direction::Right] = 1;
+        m_strides[(size_t)Direction::UpLeft] = -row - 1;
+        m_strides[(size_t)Direction::UpRight] = -row + 1;
+        m_strides[(size_t)Direction::DownLeft] = row - 1;
+        m_strides[(size_t)Direction::DownRight] = row + 1;
+
+        m_lineOffsets.push_back(0);
+        for (size_t line = 0; line < LineCount(); ++line)
+            m_lineOffsets.push_back(m_lineOffsets.back() + (uint32_t)GetLine(line).length);
+
+        // padding allows whole 16 byte loads at the end of last line
+        m_mirror.assign(2 * (size_t)m_lineOffsets.back() + 16, 0);
+        m_occupancy.assign(m_mirror.size() / 64 + 2, 0);
+        m_freeCount = m_cells.size();
+    }
+
+    void Board::Set(size_t row, size_t col, uint8_t value)
+    {
+        auto& cell = m_cells[Index(row, col)];
+        bool occupied = value != 0;
+        m_freeCount = m_freeCount + (cell != 0) - occupied;
+        cell = value;
+
+        auto lines = GetCellLines(row, col);
+        auto positions = GetCellLinePositions(row, col);
+        size_t reversed = m_lineOffsets.back();
+
+        for (size_t i = 0; i < lines.size(); ++i)
+        {
+            size_t offset = m_lineOffsets[lines[i]];
+            size_t length = m_lineOffsets[lines[i] + 1] - offset;
+
+            m_mirror[offset + positions[i]] = value;
+            m_mirror[reversed + offset + length - 1 - positions[i]] = value;
+
+            SetOccupied(offset + positions[i], occupied);
+            SetOccupied(reversed + offset + length - 1 - positions[i], occupied);
+        }
+    }
+
+    size_t Board::SpanOffset(size_t row, size_t col, Direction dir) const
+    {
+        size_t kind = GetLineKind(dir);
+        size_t line = GetCellLines(row, col)[kind];
+        size_t position = GetCellLinePositions(row, col)[kind];
+
+        size_t offset = m_lineOffsets[line];
+
+        if (IsForward(dir))
+            return offset + position;
+
+        size_t length = m_lineOffsets[line + 1] - offset;
+        return m_lineOffsets.back() + offset + length - 1 - position;
+    }
+
+    Line Board::GetLine(size_t line) const
+    {
+        size_t diagonals = m_rows + m_cols - 1;
+
+        if (line < m_rows)
+            return { Index(line, 0), Stride(Direction::Right), m_cols };
+        line -= m_rows;
+
+        if (line < m_cols)
+            return { Index(0, line), Stride(Direction::Down), m_rows };
+        line -= m_cols;
+
+        if (line < diagonals)
+        {
+            // line is (col - row) shifted to be non-negative
+            size_t row = line < m_rows - 1 ? m_rows - 1 - line : 0;
+            size_t col = line < m_rows - 1 ? 0 : line - (m_rows - 1);
+
+            return { Index(row, col), Stride(Direction::DownRight), std::min(m_rows - row, m_cols - col) };
+        }
+        line -= diagonals;
+
+        // line is (col + row)
+        size_t row = line < m_cols ? 0 : line - (m_cols - 1);
+        size_t col = line < m_cols ? line : m_cols - 1;
+
+        return { Index(row, col), Stride(Direction::DownLeft), std::min(m_rows - row, col + 1) };
+    }
+
+    bool Board::operator==(const Board& other) const
+    {
+        return m_rows == other.m_rows && m_cols == other.m_cols && m_cells == other.m_cells;
+    }
+}
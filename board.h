@@ -0,0 +1,180 @@
+#pragma once
+#include <vector>
+#include <array>
+#include <cstdint>
+#include <cstddef>
+#include <algorithm>
+
+namespace WordSearch
+{
+    enum class Direction
+    {
+        Up = 0,
+        Down,
+        Left,
+        Right,
+        UpLeft,
+        UpRight,
+        DownLeft,
+        DownRight,
+
+        COUNT
+    };
+
+    // Line of cells going through the whole board: start index, stride between cells and number of cells.
+    struct Line
+    {
+        size_t start;
+        ptrdiff_t stride;
+        size_t length;
+    };
+
+    // Index into Board::GetCellLines of line on which word in direction lies.
+    inline size_t GetLineKind(Direction dir)
+    {
+        static constexpr size_t kinds[] = { 1, 1, 0, 0, 2, 3, 3, 2 };
+
+        return kinds[(size_t)dir];
+    }
+
+    // Check if direction walks its line in order of increasing positions (see Board::GetLine).
+    inline bool IsForward(Direction dir)
+    {
+        return dir == Direction::Down || dir == Direction::Right || dir == Direction::DownLeft || dir == Direction::DownRight;
+    }
+
+    // Without hardware popcount compilers call a library function, bit trick is faster.
+    inline size_t PopCount(uint32_t value)
+    {
+        value = value - ((value >> 1) & 0x55555555u);
+        value = (value & 0x33333333u) + ((value >> 2) & 0x33333333u);
+
+        return (((value + (value >> 4)) & 0x0f0f0f0fu) * 0x01010101u) >> 24;
+    }
+
+    inline size_t PopCount(uint64_t value)
+    {
+        return PopCount((uint32_t)value) + PopCount((uint32_t)(value >> 32));
+    }
+
+    // Index of lowest set bit, value must not be 0.
+    inline size_t LowestBit(uint64_t value)
+    {
+        return PopCount((value & (0 - value)) - 1);
+    }
+
+    // Board cells stored in one contiguous row-major buffer. Empty cell is 0.
+    // Word walk in any direction is a start index plus constant stride (see Stride).
+    // Board also keeps line-major mirror of cells: every line stored contiguously in both
+    // orientations, so cells of word in any direction form a contiguous span (see Span).
+    // Mirror has bitmask of occupied cells in the same layout, so number of empty cells of any span
+    // is a popcount (see CountEmpty). All writes go through Set, which keeps the mirror, its
+    // occupancy and number of free cells up to date.
+    class Board
+    {
+    public:
+        Board() = default;
+        Board(size_t rows, size_t cols);
+
+        size_t Rows() const { return m_rows; }
+        size_t Cols() const { return m_cols; }
+        size_t CellCount() const { return m_cells.size(); }
+
+        size_t Index(size_t row, size_t col) const { return row * m_cols + col; }
+        // Difference of indices of two consecutive cells when walking in direction.
+        ptrdiff_t Stride(Direction dir) const { return m_strides[(size_t)dir]; }
+
+        uint8_t Get(size_t row, size_t col) const { return m_cells[Index(row, col)]; }
+        void Set(size_t row, size_t col, uint8_t value);
+        void Set(size_t index, uint8_t value) { Set(index / m_cols, index % m_cols, value); }
+
+        // Lines are numbered rows first, then columns, diagonals (UpLeft - DownRight)
+        // and anti-diagonals (UpRight - DownLeft).
+        size_t LineCount() const { return m_rows == 0 || m_cols == 0 ? 0 : m_rows + m_cols + 2 * (m_rows + m_cols - 1); }
+        Line GetLine(size_t line) const;
+        // Return ids of row, column, diagonal and anti-diagonal going through cell.
+        std::array<size_t, 4> GetCellLines(size_t row, size_t col) const
+        {
+            size_t diagonals = m_rows + m_cols - 1;
+
+            return
+            {
+                row,
+                m_rows + col,
+                m_rows + m_cols + (col + m_rows - 1 - row),
+                m_rows + m_cols + diagonals + (row + col)
+            };
+        }
+
+        // Return positions of cell on lines returned by GetCellLines.
+        std::array<size_t, 4> GetCellLinePositions(size_t row, size_t col) const
+        {
+            return
+            {
+                col,
+                row,
+                std::min(row, col),
+                row + col < m_cols ? row : m_cols - 1 - col
+            };
+        }
+
+        const uint8_t* Data() const { return m_cells.data(); }
+
+        // Cells starting at cell and walking in direction, contiguous until the end of line.
+        // At least 16 bytes after the end of line are readable.
+        const uint8_t* Span(size_t row, size_t col, Direction dir) const { return Mirror() + SpanOffset(row, col, dir); }
+        // Offset of Span in Mirror, it depends only on board size, so it can be precomputed.
+        size_t SpanOffset(size_t row, size_t col, Direction dir) const;
+        const uint8_t* Mirror() const { return m_mirror.data(); }
+
+        // Number of empty cells of span of size on offset in Mirror.
+        size_t CountEmpty(size_t offset, size_t size) const
+        {
+            size_t result = 0;
+
+            for (; size > 64; offset += 64, size -= 64)
+                result += 64 - PopCount(GetOccupancy(offset, 64));
+
+            return result + size - PopCount(GetOccupancy(offset, size));
+        }
+        size_t CountEmpty(size_t row, size_t col, Direction dir, size_t size) const { return CountEmpty(SpanOffset(row, col, dir), size); }
+
+        size_t FreeCellCount() const { return m_freeCount; }
+
+        bool operator==(const Board& other) const;
+        bool operator!=(const Board& other) const { return !(*this == other); }
+
+    private:
+        size_t m_rows = 0;
+        size_t m_cols = 0;
+        std::array<ptrdiff_t, (size_t)Direction::COUNT> m_strides{};
+
+        std::vector<uint8_t> m_cells;
+
+        // offsets of lines in one orientation of mirror, reversed lines follow after all forward ones
+        std::vector<uint32_t> m_lineOffsets;
+        std::vector<uint8_t> m_mirror;
+
+        // Bits of occupied cells of span of at most 64 cells on offset in Mirror.
+        uint64_t GetOccupancy(size_t offset, size_t size) const
+        {
+            size_t shift = offset % 64;
+            uint64_t bits = m_occupancy[offset / 64] >> shift;
+
+            if (shift != 0)
+                bits |= m_occupancy[offset / 64 + 1] << (64 - shift);
+
+            return size == 64 ? bits : bits & ((1ull << size) - 1);
+        }
+
+        void SetOccupied(size_t offset, bool occupied)
+        {
+            uint64_t bit = 1ull << (offset % 64);
+            m_occupancy[offset / 64] = occupied ? m_occupancy[offset / 64] | bit : m_occupancy[offset / 64] & ~bit;
+        }
+
+        // bit for each byte of mirror, with one padding word
+        std::vector<uint64_t> m_occupancy;
+        size_t m_freeCount = 0;
+    };
+}
@@ -0,0 +1,223 @@
+#include "candidates.h"
+#include <map>
+#include <mutex>
+#include <tuple>
+#include <numeric>
+#include <algorithm>
+
+namespace WordSearch
+{
+    // Cached tables by board size with their last use, least recently used one is released
+    // when there are more than MAX_CACHED_TABLES.
+    struct CachedTable
+    {
+        std::shared_ptr<const CandidateTable> table;
+        uint64_t lastUse = 0;
+    };
+
+    std::mutex g_candidateTablesMutex;
+    std::map<std::tuple<size_t, size_t>, CachedTable> g_candidateTables;
+    uint64_t g_candidateTablesUse = 0;
+
+    std::vector<Candidate> GenerateCandidates(int boardRows, int boardCols, int wordSize)
+    {
+        std::vector<Candidate> result;
+        int countRow = (boardRows - wordSize + 1) * boardCols;
+        int countDiag = (boardRows - wordSize + 1) * (boardCols - wordSize + 1);
+
+        // Up
+        for (int r = wordSize - 1; r < boardRows; ++r)
+            for (int c = 0; c < boardCols; ++c)
+                result.push_back({ r, c, Direction::Up });
+
+        // Down
+        for (int r = 0; r < boardRows - wordSize + 1; ++r)
+            for (int c = 0; c < boardCols; ++c)
+                result.push_back({ r, c, Direction::Down });
+
+        // Left
+        for (int r = 0; r < boardRows; ++r)
+            for (int c = wordSize - 1; c < boardCols; ++c)
+                result.push_back({ r, c, Direction::Left });
+
+        // Right
+        for (int r = 0; r < boardRows; ++r)
+            for (int c = 0; c < boardCols - wordSize + 1; ++c)
+                result.push_back({ r, c, Direction::Right });
+
+        // UpLeft
+        for (int r = wordSize - 1; r < boardRows; ++r)
+            for (int c = wordSize - 1; c < boardCols; ++c)
+                result.push_back({ r, c, Direction::UpLeft });
+
+        // UpRight
+        for (int r = wordSize - 1; r < boardRows; ++r)
+            for (int c = 0; c < boardCols - wordSize + 1; ++c)
+                result.push_back({ r, c, Direction::UpRight });
+
+        // DownLeft
+        for (int r = 0; r < boardRows - wordSize + 1; ++r)
+            for (int c = wordSize - 1; c < boardCols; ++c)
+                result.push_back({ r, c, Direction::DownLeft });
+
+        // DownRight
+        for (int r = 0; r < boardRows - wordSize + 1; ++r)
+            for (int c = 0; c < boardCols - wordSize + 1; ++c)
+                result.push_back({ r, c, Direction::DownRight });
+
+        return result;
+    }
+
+    ProcessedCandidates ProcessCandidates(Candidates&& candidates)
+    {
+        ProcessedCandidates result;
+
+        for (size_t wordSize = 0; wordSize < candidates.size(); ++wordSize)
+        {
+            for (auto&& candidate : candidates[wordSize])
+            {
+                result[(size_t)candidate.dir][wordSize].push_back(std::move(candidate));
+            }
+        }
+
+        return result;
+    }
+
+    std::shared_ptr<const CandidateTable> GetCandidateTable(size_t rows, size_t cols)
+    {
+        {
+            std::lock_guard<std::mutex> lock(g_candidateTablesMutex);
+
+            auto it = g_candidateTables.find({ rows, cols });
+            if (it != std::end(g_candidateTables))
+            {
+                it->second.lastUse = ++g_candidateTablesUse;
+                return it->second.table;
+            }
+        }
+
+        // generate outside of lock, if other thread was faster its table is used
+        auto table = std::make_shared<CandidateTable>();
+        table->rows = rows;
+        table->cols = cols;
+
+        Board geometry(rows, cols);
+
+        for (size_t dir = 0; dir < (size_t)Direction::COUNT; ++dir)
+        {
+            size_t kind = GetLineKind((Direction)dir);
+            bool forward = IsForward((Direction)dir);
+
+            for (size_t size = Dictionary::MIN_WORD_SIZE; size < Dictionary::MAX_WORD_SIZE; ++size)
+            {
+                auto& candidates = table->candidates[dir][size];
+                auto& lineStarts = table->lineStarts[dir][size];
+
+                table->offsets[dir][size] = table->count;
+                lineStarts.reserve(geometry.LineCount() + 1);
+
+                for (size_t lineId = 0; lineId < geometry.LineCount(); ++lineId)
+                {
+                    lineStarts.push_back((uint32_t)candidates.size());
+
+                    auto line = geometry.GetLine(lineId);
+                    if (line.length < size)
+                        continue;
+
+                    // only lines of kind matching direction, cells of other lines are not on them
+                    auto cell = (ptrdiff_t)line.start;
+                    if (geometry.GetCellLines(cell / cols, cell % cols)[kind] != lineId)
+                        continue;
+
+                    for (size_t position = 0; position + size <= line.length; ++position)
+                    {
+                        size_t start = line.start + (forward ? position : position + size - 1) * line.stride;
+                        candidates.push_back({ (int)(start / cols), (int)(start % cols), (Direction)dir });
+                        table->spans[dir][size].push_back((uint32_t)geometry.SpanOffset(start / cols, start % cols, (Direction)dir));
+                    }
+                }
+
+                lineStarts.push_back((uint32_t)candidates.size());
+                table->count += candidates.size();
+            }
+        }
+
+        std::lock_guard<std::mutex> lock(g_candidateTablesMutex);
+
+        auto& cached = g_candidateTables.emplace(std::make_tuple(rows, cols), CachedTable{ std::move(table) }).first->second;
+        cached.lastUse = ++g_candidateTablesUse;
+        auto result = cached.table;
+
+        if (g_candidateTables.size() > MAX_CACHED_TABLES)
+        {
+            auto oldest = std::min_element(std::begin(g_candidateTables), std::end(g_candidateTables),
+                [](const auto& a, const auto& b) { return a.second.lastUse < b.second.lastUse; });
+            g_candidateTables.erase(oldest);
+        }
+
+        return result;
+    }
+
+    void ClearCandidateTables()
+    {
+        std::lock_guard<std::mutex> lock(g_candidateTablesMutex);
+
+        g_candidateTables.clear();
+    }
+
+    CandidateView::CandidateView(std::shared_ptr<const CandidateTable> table)
+        : m_table(std::move(table))
+    {
+        m_dead.assign((m_table->count + 63) / 64, 0);
+    }
+
+    std::vector<uint32_t>& CandidateView::Live(Direction dir, size_t size)
+    {
+        auto& live = m_live[(size_t)dir][size];
+
+        if (!m_started[(size_t)dir][size])
+        {
+            m_started[(size_t)dir][size] = true;
+            live.resize(m_table->candidates[(size_t)dir][size].size());
+            std::iota(std::begin(live), std::end(live), 0);
+        }
+
+        return live;
+    }
+
+    void CandidateView::RemoveIntercepting(const Board& board, const Candidate& position, size_t size)
+    {
+        size_t kind = GetLineKind(position.dir);
+        size_t line = board.GetCellLines(position.row, position.col)[kind];
+        size_t cellPosition = board.GetCellLinePositions(position.row, position.col)[kind];
+
+        // positions [first, last] of line covered by word
+        size_t first = IsForward(position.dir) ? cellPosition : cellPosition + 1 - size;
+        size_t last = first + size - 1;
+
+        auto removeIntercepting = [&](Direction dir)
+        {
+            for (size_t itSize = Dictionary::MIN_WORD_SIZE; itSize < Dictionary::MAX_WORD_SIZE; ++itSize)
+            {
+                const auto& lineStarts = m_table->lineStarts[(size_t)dir][itSize];
+                size_t lineCount = lineStarts[line + 1] - lineStarts[line];
+                if (lineCount == 0)
+                    continue;
+
+                // candidates with lowest position in [first - itSize + 1, last] overlap word
+                size_t from = first + 1 >= itSize ? first + 1 - itSize : 0;
+                size_t to = std::min(last, lineCount - 1);
+
+                for (size_t p = from; p <= to; ++p)
+                {
+                    size_t bit = m_table->offsets[(size_t)dir][itSize] + lineStarts[line] + p;
+                    m_dead[bit / 64] |= 1ull << (bit % 64);
+                }
+            }
+        };
+
+        // same direction
+        removeIntercepting(position.dir);
+        removeIntercepting(GetOpositeDirection(position.dir));
+    }
+}
@@ -0,0 +1,77 @@
+#pragma once
+#include <memory>
+#include <vector>
+#include <array>
+#include "wordSearch.h"
+
+namespace WordSearch
+{
+    // we process candidates to form data[direction][wordSize]
+    // reason is that we want to pick direction uniformly at random
+    using ProcessedCandidates = std::array<Candidates, (size_t)Direction::COUNT>;
+
+    std::vector<Candidate> GenerateCandidates(int boardRows, int boardCols, int wordSize);
+    ProcessedCandidates ProcessCandidates(Candidates&& candidates);
+    Direction GetOpositeDirection(Direction dir);
+
+    // All candidates of one board size. Table is immutable once created and it is shared
+    // by every generation run (and thread) using the same board size.
+    // Candidates of each direction and size are grouped by board line (see Board::GetLine) and
+    // ordered by lowest position they cover, so candidate covering positions [p, p + size) of
+    // line has index lineStarts[dir][size][line] + p.
+    struct CandidateTable
+    {
+        size_t rows = 0;
+        size_t cols = 0;
+
+        ProcessedCandidates candidates;
+        // offsets of candidate spans in Board::Mirror, same layout as candidates
+        std::array<std::array<std::vector<uint32_t>, Dictionary::MAX_WORD_SIZE>, (size_t)Direction::COUNT> spans;
+        std::array<std::array<std::vector<uint32_t>, Dictionary::MAX_WORD_SIZE>, (size_t)Direction::COUNT> lineStarts;
+
+        // position of first candidate of direction and size in numbering of all candidates
+        std::array<std::array<size_t, Dictionary::MAX_WORD_SIZE>, (size_t)Direction::COUNT> offsets{};
+        size_t count = 0;
+    };
+
+    // Most recently used tables kept in cache, older ones are released once no run uses them.
+    static constexpr size_t MAX_CACHED_TABLES = 8;
+
+    // Return cached table for board size, table is generated on first request.
+    std::shared_ptr<const CandidateTable> GetCandidateTable(size_t rows, size_t cols);
+    // Release all cached tables, tables still used by running generations stay alive until they end.
+    void ClearCandidateTables();
+
+    // Candidates still available in one generation run. Only indices into shared table are kept,
+    // their order is shuffled by the user. Live list of direction and size is filled on its first
+    // use, so runs pay only for sizes they draw. Removed candidates are marked in a tombstone
+    // bitset and they stay in Live lists until the user drops them (see IsLive).
+    class CandidateView
+    {
+    public:
+        CandidateView() = default;
+        explicit CandidateView(std::shared_ptr<const CandidateTable> table);
+
+        const Candidate& Get(Direction dir, size_t size, uint32_t index) const { return m_table->candidates[(size_t)dir][size][index]; }
+        uint32_t SpanOffset(Direction dir, size_t size, uint32_t index) const { return m_table->spans[(size_t)dir][size][index]; }
+
+        std::vector<uint32_t>& Live(Direction dir, size_t size);
+
+        bool IsLive(Direction dir, size_t size, uint32_t index) const
+        {
+            size_t bit = m_table->offsets[(size_t)dir][size] + index;
+
+            return (m_dead[bit / 64] & (1ull << (bit % 64))) == 0;
+        }
+
+        // Remove candidates in same or opposite direction overlapping word of size on position.
+        // Board is used only for its line geometry.
+        void RemoveIntercepting(const Board& board, const Candidate& position, size_t size);
+
+    private:
+        std::shared_ptr<const CandidateTable> m_table;
+        std::array<std::array<std::vector<uint32_t>, Dictionary::MAX_WORD_SIZE>, (size_t)Direction::COUNT> m_live;
+        std::array<std::array<bool, Dictionary::MAX_WORD_SIZE>, (size_t)Direction::COUNT> m_started{};
+        std::vector<uint64_t> m_dead;
+    };
+}
@@ -1,59 +1,214 @@
 #include "dictionary.h"
 #include <fstream>
-#include <random>
+#include <algorithm>
+#include <bitset>
 
 namespace Dictionary
 {
-    std::random_device g_rd;
-    std::mt19937 g_mt(g_rd());
+    // Failed draws of GetRandomWords before it gives up.
+    static constexpr size_t MAX_RANDOM_WORD_MISSES = 100000;
+
+    void WordList::Add(std::string_view word)
+    {
+        if (m_attached.data())
+        {
+            m_letters.assign(m_attached);
+            m_attached = {};
+        }
+
+        m_wordSize = word.size();
+        m_letters.append(word);
+    }
+
+    void WordList::Attach(size_t wordSize, std::string_view letters)
+    {
+        m_wordSize = wordSize;
+        m_letters.clear();
+        m_attached = letters;
+    }
 
     Data ReadDictionary(const std::string& path)
     {
         Data result;
         std::ifstream file(path);
+        std::string word;
 
-        while (file)
+        while (file >> word)
         {
-            std::string word;
-            file >> word;
-
             if (word.size() >= result.size())
                 continue;
 
-            result[word.size()].push_back(word);
+            result[word.size()].Add(word);
         }
 
         return result;
     }
 
-    std::optional<std::string> GetRandomWord(const Data& data, size_t wordSize)
+    PatternIndex::PatternIndex(const Data& data)
+        : m_data(data)
     {
-        size_t wordCount = data[wordSize].size();
-        if (wordCount == 0)
+        for (size_t size = 0; size < data.size(); ++size)
+        {
+            for (size_t i = 0; i < data[size].Count(); ++i)
+            {
+                for (auto character : data[size][i])
+                {
+                    if (m_codes[(uint8_t)character] == 0)
+                        m_codes[(uint8_t)character] = (uint8_t)m_codeCount++;
+                }
+            }
+        }
+
+        for (size_t size = 0; size < data.size(); ++size)
+        {
+            size_t count = data[size].Count();
+            m_bits[size].assign(size * m_codeCount, Bits((count + 63) / 64, 0));
+
+            for (size_t i = 0; i < count; ++i)
+            {
+                auto word = data[size][i];
+                for (size_t position = 0; position < size; ++position)
+                    m_bits[size][position * m_codeCount + m_codes[(uint8_t)word[position]]][i / 64] |= 1ull << (i % 64);
+            }
+        }
+    }
+
+    bool PatternIndex::GetLetterBits(const uint8_t* pattern, size_t size, LetterBits& bits) const
+    {
+        for (size_t position = 0; position < size; ++position)
+        {
+            if (pattern[position] == 0)
+                continue;
+
+            auto code = m_codes[pattern[position]];
+            if (code == 0)
+                return false;
+
+            bits.bits[bits.count++] = &m_bits[size][position * m_codeCount + code];
+        }
+
+        return true;
+    }
+
+    template<class T>
+    void PatternIndex::ForEachBlock(size_t size, const LetterBits& bits, T function) const
+    {
+        size_t count = m_data[size].Count();
+
+        for (size_t block = 0; block < (count + 63) / 64; ++block)
+        {
+            uint64_t match = block + 1 < (count + 63) / 64 || count % 64 == 0 ? ~0ull : (1ull << (count % 64)) - 1;
+            for (size_t i = 0; i < bits.count; ++i)
+                match &= (*bits.bits[i])[block];
+
+            if (!function(block, match))
+                return;
+        }
+    }
+
+    size_t PatternIndex::CountMatches(const uint8_t* pattern, size_t size) const
+    {
+        LetterBits bits;
+        if (size >= m_data.size() || !GetLetterBits(pattern, size, bits))
+            return 0;
+
+        size_t result = 0;
+        ForEachBlock(size, bits, [&result](size_t, uint64_t match)
+            {
+                result += std::bitset<64>(match).count();
+                return true;
+            });
+
+        return result;
+    }
+
+    std::optional<std::string_view> PatternIndex::GetRandomMatch(Random::Generator& generator, const uint8_t* pattern, size_t size) const
+    {
+        size_t count = CountMatches(pattern, size);
+        if (count == 0)
             return std::nullopt;
 
-        std::uniform_int_distribution<size_t> rand(0, wordCount - 1);
+        LetterBits bits;
+        GetLetterBits(pattern, size, bits);
 
-        auto it = std::begin(data[wordSize]);
-        std::advance(it, rand(g_mt));
+        // n-th match
+        size_t n = generator.Range(0, count - 1);
+        std::optional<std::string_view> result;
 
-        return *it;
+        ForEachBlock(size, bits, [&](size_t block, uint64_t match)
+            {
+                size_t blockCount = std::bitset<64>(match).count();
+                if (n >= blockCount)
+                {
+                    n -= blockCount;
+                    return true;
+                }
+
+                for (; n != 0; --n)
+                    match &= match - 1;
+
+                size_t bit = 0;
+                while ((match & (1ull << bit)) == 0)
+                    bit++;
+
+                result = m_data[size][block * 64 + bit];
+                return false;
+            });
+
+        return result;
     }
 
-    std::vector<std::string> GetRandomWords(const Data& data, size_t wordCount, size_t wordSizeFrom, size_t wordSizeTo)
+    LetterCounts CountLetters(const Data& data)
     {
-        std::uniform_int_distribution<size_t> randWordSize(wordSizeFrom, wordSizeTo);
+        LetterCounts result{};
 
-        std::vector<std::string> result;
+        for (const auto& words : data)
+        {
+            for (auto character : words.Letters())
+                result[(uint8_t)character]++;
+        }
+
+        return result;
+    }
+
+    std::optional<std::string_view> GetRandomWord(Random::Generator& generator, const Data& data, size_t wordSize)
+    {
+        if (wordSize >= data.size())
+            return std::nullopt;
+
+        size_t wordCount = data[wordSize].Count();
+        if (wordCount == 0)
+            return std::nullopt;
+
+        return data[wordSize][generator.Range(0, wordCount - 1)];
+    }
+
+    std::optional<std::vector<std::string_view>> GetRandomWords(Random::Generator& generator, const Data& data, size_t wordCount, size_t wordSizeFrom, size_t wordSizeTo)
+    {
+        size_t available = 0;
+        for (size_t size = wordSizeFrom; size <= wordSizeTo && size < data.size(); ++size)
+            available += data[size].Count();
+
+        if (available < wordCount)
+            return std::nullopt;
+
+        // list may contain the same word more than once, so draws are bounded too
+        size_t misses = 0;
+
+        std::vector<std::string_view> result;
         while (result.size() != wordCount)
         {
-            if (auto word = GetRandomWord(data, randWordSize(g_mt)))
+            auto word = GetRandomWord(generator, data, generator.Range(wordSizeFrom, wordSizeTo));
+
+            if (!word || std::find(std::begin(result), std::end(result), *word) != std::end(result))
             {
-                if (std::find(std::begin(result), std::end(result), *word) != std::end(result))
-                    continue;
+                if (++misses == MAX_RANDOM_WORD_MISSES)
+                    return std::nullopt;
 
-                result.push_back(std::move(*word));
+                continue;
             }
+
+            result.push_back(*word);
         }
 
         return result;
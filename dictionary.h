@@ -2,18 +2,86 @@
 #include <map>
 #include <vector>
 #include <string>
+#include <string_view>
 #include <array>
 #include <optional>
+#include <cstdint>
+#include "random.h"
 
 namespace Dictionary
 {
     static constexpr size_t MIN_WORD_SIZE = 3;
     static constexpr size_t MAX_WORD_SIZE = 25;
 
-    using Data = std::array<std::vector<std::string>, MAX_WORD_SIZE>;
+    // Words of one size stored back-to-back in a single arena, word is addressed by index.
+    // Arena is owned by the list or it is attached memory (e.g. mapped file, see MappedDictionary).
+    class WordList
+    {
+    public:
+        size_t Count() const { return m_wordSize == 0 ? 0 : Letters().size() / m_wordSize; }
+        std::string_view operator[](size_t index) const { return { Letters().data() + index * m_wordSize, m_wordSize }; }
+
+        void Add(std::string_view word);
+        // Use words of wordSize stored back-to-back in letters, memory must outlive the list.
+        // Attached words are copied to owned arena on next Add.
+        void Attach(size_t wordSize, std::string_view letters);
+
+        std::string_view Letters() const { return m_attached.data() ? m_attached : std::string_view(m_letters); }
+
+    private:
+        size_t m_wordSize = 0;
+        std::string m_letters;
+        std::string_view m_attached;
+    };
+
+    using Data = std::array<WordList, MAX_WORD_SIZE>;
 
     Data ReadDictionary(const std::string& path);
 
-    std::optional<std::string> GetRandomWord(const Data& data, size_t wordSize);
-    std::vector<std::string> GetRandomWords(const Data& data, size_t wordCount, size_t wordSizeFrom = MIN_WORD_SIZE, size_t wordSizeTo = MAX_WORD_SIZE);
+    // Number of occurrences of each character in words.
+    using LetterCounts = std::array<uint64_t, 256>;
+
+    LetterCounts CountLetters(const Data& data);
+
+    // Words of each size indexed by letter at each position (one bitset over words per size,
+    // position and letter), so words fitting partially filled slot are found by AND of bitsets
+    // of its fixed letters. Index refers to data, which must outlive it.
+    class PatternIndex
+    {
+    public:
+        explicit PatternIndex(const Data& data);
+
+        // Pattern is one character per letter of word, 0 matches any letter.
+        size_t CountMatches(const uint8_t* pattern, size_t size) const;
+        std::optional<std::string_view> GetRandomMatch(Random::Generator& generator, const uint8_t* pattern, size_t size) const;
+
+    private:
+        using Bits = std::vector<uint64_t>;
+
+        struct LetterBits
+        {
+            std::array<const Bits*, MAX_WORD_SIZE> bits;
+            size_t count = 0;
+        };
+
+        // Collect bitsets of fixed letters of pattern, return false if some letter is in no word.
+        bool GetLetterBits(const uint8_t* pattern, size_t size, LetterBits& bits) const;
+        // Call function(block index, matching bits) for each 64 word block while it returns true.
+        template<class T>
+        void ForEachBlock(size_t size, const LetterBits& bits, T function) const;
+
+        const Data& m_data;
+
+        // dense codes of characters used by words, 0 for others
+        std::array<uint8_t, 256> m_codes{};
+        size_t m_codeCount = 1;
+
+        // m_bits[size][position * m_codeCount + code]
+        std::array<std::vector<Bits>, MAX_WORD_SIZE> m_bits;
+    };
+
+    // Returned words point to data.
+    std::optional<std::string_view> GetRandomWord(Random::Generator& generator, const Data& data, size_t wordSize);
+    // Return nullopt if dictionary does not have enough distinct words of sizes.
+    std::optional<std::vector<std::string_view>> GetRandomWords(Random::Generator& generator, const Data& data, size_t wordCount, size_t wordSizeFrom = MIN_WORD_SIZE, size_t wordSizeTo = MAX_WORD_SIZE);
 }
@@ -0,0 +1,227 @@
+#include "dictionaryFile.h"
+#include <fstream>
+#include <vector>
+#include <algorithm>
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#else
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+namespace Dictionary
+{
+    static const char MAGIC[4] = { 'W', 'S', 'D', '1' };
+    static constexpr uint32_t LETTER_COUNTS_FLAG = 1;
+    static constexpr uint32_t ALPHABET_FLAG = 2;
+
+    static constexpr size_t HEADER_SIZE = 16;
+    static constexpr size_t TABLE_ENTRY_SIZE = 16;
+
+    void AppendLittleEndian(std::string& buffer, uint64_t value, size_t size)
+    {
+        for (size_t i = 0; i < size; ++i)
+            buffer.push_back((char)((value >> (8 * i)) & 0xff));
+    }
+
+    uint64_t ReadLittleEndian(const char* bytes, size_t size)
+    {
+        uint64_t result = 0;
+        for (size_t i = 0; i < size; ++i)
+            result |= (uint64_t)(uint8_t)bytes[i] << (8 * i);
+
+        return result;
+    }
+
+    bool WriteCompiledDictionary(const Data& data, const std::string& path, bool letterCounts, const Alphabet* alphabet)
+    {
+        Data compiled;
+        for (size_t size = 0; size < data.size(); ++size)
+        {
+            std::vector<std::string_view> words;
+            for (size_t i = 0; i < data[size].Count(); ++i)
+                words.push_back(data[size][i]);
+
+            std::sort(std::begin(words), std::end(words));
+            words.erase(std::unique(std::begin(words), std::end(words)), std::end(words));
+
+            for (auto word : words)
+                compiled[size].Add(word);
+        }
+
+        std::string header(std::begin(MAGIC), std::end(MAGIC));
+        AppendLittleEndian(header, compiled.size(), 4);
+        AppendLittleEndian(header, (letterCounts ? LETTER_COUNTS_FLAG : 0) | (alphabet ? ALPHABET_FLAG : 0), 4);
+        AppendLittleEndian(header, 0, 4);
+
+        uint64_t offset = HEADER_SIZE + compiled.size() * TABLE_ENTRY_SIZE;
+        for (const auto& words : compiled)
+        {
+            AppendLittleEndian(header, offset, 8);
+            AppendLittleEndian(header, words.Count(), 8);
+            offset += words.Letters().size();
+        }
+
+        std::ofstream file(path, std::ios::binary);
+        file.write(header.data(), (std::streamsize)header.size());
+
+        for (const auto& words : compiled)
+            file.write(words.Letters().data(), (std::streamsize)words.Letters().size());
+
+        if (letterCounts)
+        {
+            std::string counts;
+            for (auto count : CountLetters(compiled))
+                AppendLittleEndian(counts, count, 8);
+
+            file.write(counts.data(), (std::streamsize)counts.size());
+        }
+
+        if (alphabet)
+        {
+            std::string letters;
+            for (size_t code = 1; code <= alphabet->Size(); ++code)
+                letters.append(alphabet->GetLetter((uint8_t)code));
+
+            std::string section;
+            AppendLittleEndian(section, letters.size(), 8);
+            section.append(letters);
+
+            file.write(section.data(), (std::streamsize)section.size());
+        }
+
+        return (bool)file;
+    }
+
+    MappedDictionary::~MappedDictionary()
+    {
+        Close();
+    }
+
+    bool MappedDictionary::Open(const std::string& path)
+    {
+        Close();
+
+#ifdef _WIN32
+        HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+        if (file == INVALID_HANDLE_VALUE)
+            return false;
+
+        LARGE_INTEGER size;
+        HANDLE mapping = GetFileSizeEx(file, &size) && size.QuadPart != 0 ? CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr) : nullptr;
+
+        // view keeps mapping alive after handles are closed
+        if (mapping)
+        {
+            m_memory = (const char*)MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+            m_size = m_memory ? (size_t)size.QuadPart : 0;
+            CloseHandle(mapping);
+        }
+        CloseHandle(file);
+#else
+        int file = open(path.c_str(), O_RDONLY);
+        if (file < 0)
+            return false;
+
+        struct stat status;
+        if (fstat(file, &status) == 0 && status.st_size != 0)
+        {
+            void* memory = mmap(nullptr, (size_t)status.st_size, PROT_READ, MAP_SHARED, file, 0);
+            if (memory != MAP_FAILED)
+            {
+                m_memory = (const char*)memory;
+                m_size = (size_t)status.st_size;
+            }
+        }
+
+        // mapping stays valid after file is closed
+        close(file);
+#endif
+
+        if (!m_memory || !Parse())
+        {
+            Close();
+            return false;
+        }
+
+        return true;
+    }
+
+    void MappedDictionary::Close()
+    {
+        if (m_memory)
+        {
+#ifdef _WIN32
+            UnmapViewOfFile(m_memory);
+#else
+            munmap((void*)m_memory, m_size);
+#endif
+        }
+
+        m_memory = nullptr;
+        m_size = 0;
+        m_data = {};
+        m_letterCounts.reset();
+        m_alphabet.reset();
+    }
+
+    bool MappedDictionary::Parse()
+    {
+        size_t tableEnd = HEADER_SIZE + m_data.size() * TABLE_ENTRY_SIZE;
+
+        if (m_size < tableEnd || !std::equal(std::begin(MAGIC), std::end(MAGIC), m_memory) || ReadLittleEndian(m_memory + 4, 4) != m_data.size())
+            return false;
+
+        uint32_t flags = (uint32_t)ReadLittleEndian(m_memory + 8, 4);
+        uint64_t end = tableEnd;
+
+        for (size_t size = 0; size < m_data.size(); ++size)
+        {
+            auto entry = m_memory + HEADER_SIZE + size * TABLE_ENTRY_SIZE;
+            uint64_t offset = ReadLittleEndian(entry, 8);
+            uint64_t count = ReadLittleEndian(entry + 8, 8);
+
+            if (offset < tableEnd || offset > m_size || (size != 0 && count > (m_size - offset) / size))
+                return false;
+
+            m_data[size].Attach(size, { m_memory + offset, (size_t)(count * size) });
+            end = std::max(end, offset + count * size);
+        }
+
+        if (flags & LETTER_COUNTS_FLAG)
+        {
+            if (m_size - end < sizeof(LetterCounts))
+                return false;
+
+            m_letterCounts.emplace();
+            for (size_t i = 0; i < m_letterCounts->size(); ++i)
+                (*m_letterCounts)[i] = ReadLittleEndian(m_memory + end + 8 * i, 8);
+
+            end += sizeof(LetterCounts);
+        }
+
+        if (flags & ALPHABET_FLAG)
+        {
+            if (m_size - end < 8)
+                return false;
+
+            uint64_t size = ReadLittleEndian(m_memory + end, 8);
+            if (m_size - end - 8 < size)
+                return false;
+
+            // letters are added in order of their codes, so codes of stored words are restored
+            m_alphabet.emplace();
+            if (!m_alphabet->AddLetters({ m_memory + end + 8, (size_t)size }))
+                return false;
+        }
+
+        return true;
+    }
+}
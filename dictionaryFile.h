@@ -0,0 +1,52 @@
+#pragma once
+#include <string>
+#include <array>
+#include <optional>
+#include <cstdint>
+#include "dictionary.h"
+#include "alphabet.h"
+
+namespace Dictionary
+{
+    // Compiled dictionary is a binary file which is used without parsing:
+    //   header: "WSD1", number of word sizes (MAX_WORD_SIZE), flags (1 = letter counts present,
+    //           2 = alphabet present) and reserved 0, all uint32 little endian
+    //   table:  for each word size offset of its words in file and number of words, uint64
+    //   words:  words of each size sorted, deduplicated and stored back-to-back (see WordList)
+    //   letter counts (optional): LetterCounts as uint64
+    //   alphabet (optional): size in bytes (uint64) and UTF-8 letters in order of their codes
+    // Words encoded by alphabet (see Alphabet) need it to be decoded, so it is stored with them.
+    // Return false if file can't be written.
+    bool WriteCompiledDictionary(const Data& data, const std::string& path, bool letterCounts = true, const Alphabet* alphabet = nullptr);
+
+    // Compiled dictionary mapped to memory. Word lists of Data refer directly to the mapping, so
+    // opening does no parsing and pages are shared by all processes which map the same file.
+    // Data is valid until the dictionary is destroyed.
+    class MappedDictionary
+    {
+    public:
+        MappedDictionary() = default;
+        ~MappedDictionary();
+
+        MappedDictionary(const MappedDictionary&) = delete;
+        MappedDictionary& operator=(const MappedDictionary&) = delete;
+
+        // Return false if file can't be mapped or it is not a valid compiled dictionary.
+        bool Open(const std::string& path);
+        void Close();
+
+        const Data& GetData() const { return m_data; }
+        const std::optional<LetterCounts>& GetLetterCounts() const { return m_letterCounts; }
+        const std::optional<Alphabet>& GetAlphabet() const { return m_alphabet; }
+
+    private:
+        bool Parse();
+
+        const char* m_memory = nullptr;
+        size_t m_size = 0;
+
+        Data m_data;
+        std::optional<LetterCounts> m_letterCounts;
+        std::optional<Alphabet> m_alphabet;
+    };
+}
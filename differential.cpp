@@ -0,0 +1,315 @@
+#include "differential.h"
+#include "wordSearch.h"
+#include "candidates.h"
+#include "finder.h"
+#include <map>
+#include <string>
+#include <iomanip>
+#include <algorithm>
+#include <functional>
+
+namespace WordSearch
+{
+    bool VerifyWord(const Board& board, const Candidate& position, std::string_view word);
+    size_t CountEmptyCells(const Board& board, const Candidate& position, std::string_view word);
+    bool CheckWord(const Board& board, const Candidate& position, std::string_view word);
+    bool IsAnyWordDuplicated(const Board& board, const Words& words, const Candidates& candidates);
+    void RemoveInterceptingCandidates(const Candidate& candidate, size_t candidateSize, ProcessedCandidates& candidates);
+
+    Candidates GetCandidates(size_t rows, size_t cols);
+}
+
+namespace Test
+{
+    using Clock = std::chrono::steady_clock;
+
+    // few letters, so random words often fit and occur more than once
+    static const char LETTERS[] = "abcd";
+    static constexpr size_t MIN_BOARD_SIZE = 3;
+    static constexpr size_t MAX_BOARD_SIZE = 20;
+
+    double DifferentialResult::Speedup() const
+    {
+        return fastTime.count() != 0 ? (double)referenceTime.count() / fastTime.count() : 0;
+    }
+
+    // Call function(cell, index in word) for cells of word on position, walked one by one in
+    // row-major cells.
+    template<class T>
+    void ForEachWordCell(const WordSearch::Board& board, const WordSearch::Candidate& position, size_t size, T function)
+    {
+        auto stride = board.Stride(position.dir);
+        auto index = (ptrdiff_t)board.Index(position.row, position.col);
+
+        for (size_t i = 0; i < size; ++i, index += stride)
+            function(board.Data()[index], i);
+    }
+
+    bool ReferenceVerifyWord(const WordSearch::Board& board, const WordSearch::Candidate& position, std::string_view word)
+    {
+        bool result = true;
+        ForEachWordCell(board, position, word.size(), [&](uint8_t cell, size_t i) { result = result && (cell == 0 || cell == (uint8_t)word[i]); });
+
+        return result;
+    }
+
+    bool ReferenceCheckWord(const WordSearch::Board& board, const WordSearch::Candidate& position, std::string_view word)
+    {
+        bool result = true;
+        ForEachWordCell(board, position, word.size(), [&](uint8_t cell, size_t i) { result = result && cell == (uint8_t)word[i]; });
+
+        return result;
+    }
+
+    size_t ReferenceCountEmptyCells(const WordSearch::Board& board, const WordSearch::Candidate& position, std::string_view word)
+    {
+        size_t result = 0;
+        ForEachWordCell(board, position, word.size(), [&](uint8_t cell, size_t) { result += cell == 0 ? 1 : 0; });
+
+        return result;
+    }
+
+    char RandomLetter(Random::Generator& generator)
+    {
+        return LETTERS[generator.Range(0, sizeof(LETTERS) - 2)];
+    }
+
+    std::string RandomWord(Random::Generator& generator, size_t size)
+    {
+        std::string result;
+        for (size_t i = 0; i < size; ++i)
+            result.push_back(RandomLetter(generator));
+
+        return result;
+    }
+
+    // Board with random share of cells (from none to all) set to random letters.
+    WordSearch::Board RandomBoard(Random::Generator& generator)
+    {
+        WordSearch::Board result(generator.Range(MIN_BOARD_SIZE, MAX_BOARD_SIZE), generator.Range(MIN_BOARD_SIZE, MAX_BOARD_SIZE));
+        size_t percent = generator.Range(0, 100);
+
+        for (size_t i = 0; i < result.CellCount(); ++i)
+        {
+            if (generator.Range(1, 100) <= percent)
+                result.Set(i, (uint8_t)RandomLetter(generator));
+        }
+
+        return result;
+    }
+
+    size_t RandomWordSize(Random::Generator& generator, const WordSearch::Board& board)
+    {
+        return generator.Range(Dictionary::MIN_WORD_SIZE, std::min(std::max(board.Rows(), board.Cols()), Dictionary::MAX_WORD_SIZE - 1));
+    }
+
+    // Time reference and fast over all cases, then compare their results by equal.
+    template<class Reference, class Fast, class Equal>
+    DifferentialResult Compare(const char* name, size_t cases, Reference reference, Fast fast, Equal equal)
+    {
+        DifferentialResult result;
+        result.name = name;
+        result.cases = cases;
+
+        std::vector<decltype(reference(0))> expected;
+        std::vector<decltype(fast(0))> actual;
+        expected.reserve(cases);
+        actual.reserve(cases);
+
+        auto start = Clock::now();
+        for (size_t i = 0; i < cases; ++i)
+            expected.push_back(reference(i));
+
+        auto middle = Clock::now();
+        for (size_t i = 0; i < cases; ++i)
+            actual.push_back(fast(i));
+
+        auto end = Clock::now();
+        result.referenceTime = middle - start;
+        result.fastTime = end - middle;
+
+        for (size_t i = 0; i < cases; ++i)
+            result.mismatches += equal(expected[i], actual[i]) ? 0 : 1;
+
+        return result;
+    }
+
+    std::vector<DifferentialResult> RunDifferential(uint64_t seed, size_t iterations)
+    {
+        Random::Generator generator(seed);
+        std::vector<DifferentialResult> results;
+
+        std::vector<WordSearch::Board> boards;
+        for (size_t i = 0; i < iterations / 16 + 1; ++i)
+            boards.push_back(RandomBoard(generator));
+
+        std::map<std::tuple<size_t, size_t>, WordSearch::Candidates> candidates;
+        for (const auto& board : boards)
+            candidates.try_emplace({ board.Rows(), board.Cols() }, WordSearch::GetCandidates(board.Rows(), board.Cols()));
+
+        auto getCandidates = [&](const WordSearch::Board& board) -> const WordSearch::Candidates& { return candidates.at({ board.Rows(), board.Cols() }); };
+
+        // word on candidate: copy of its cells (so it fits), with one letter changed, or random
+        struct WordCase
+        {
+            const WordSearch::Board* board;
+            WordSearch::Candidate position;
+            std::string word;
+        };
+
+        std::vector<WordCase> wordCases;
+        for (size_t i = 0; i < iterations; ++i)
+        {
+            const auto& board = boards[generator.Range(0, boards.size() - 1)];
+            size_t size = RandomWordSize(generator, board);
+            const auto& sized = getCandidates(board)[size];
+            auto position = sized[generator.Range(0, sized.size() - 1)];
+
+            auto word = RandomWord(generator, size);
+            size_t kind = generator.Range(0, 2);
+            if (kind != 0)
+            {
+                ForEachWordCell(board, position, size, [&](uint8_t cell, size_t j) { word[j] = cell != 0 ? (char)cell : word[j]; });
+
+                if (kind == 2)
+                    word[generator.Range(0, size - 1)] = RandomLetter(generator);
+            }
+
+            wordCases.push_back({ &board, position, std::move(word) });
+        }
+
+        auto equal = std::equal_to<>();
+
+        results.push_back(Compare("VerifyWord", wordCases.size(),
+            [&](size_t i) { return ReferenceVerifyWord(*wordCases[i].board, wordCases[i].position, wordCases[i].word); },
+            [&](size_t i) { return WordSearch::VerifyWord(*wordCases[i].board, wordCases[i].position, wordCases[i].word); },
+            equal));
+
+        results.push_back(Compare("CheckWord", wordCases.size(),
+            [&](size_t i) { return ReferenceCheckWord(*wordCases[i].board, wordCases[i].position, wordCases[i].word); },
+            [&](size_t i) { return WordSearch::CheckWord(*wordCases[i].board, wordCases[i].position, wordCases[i].word); },
+            equal));
+
+        results.push_back(Compare("CountEmptyCells", wordCases.size(),
+            [&](size_t i) { return ReferenceCountEmptyCells(*wordCases[i].board, wordCases[i].position, wordCases[i].word); },
+            [&](size_t i) { return WordSearch::CountEmptyCells(*wordCases[i].board, wordCases[i].position, wordCases[i].word); },
+            equal));
+
+        // few short words, full boards of few letters have many of them more than once
+        struct WordsCase
+        {
+            const WordSearch::Board* board;
+            std::vector<std::string> letters;
+            WordSearch::Words words;
+        };
+
+        std::vector<WordsCase> wordsCases(iterations / 16 + 1);
+        for (auto& wordsCase : wordsCases)
+        {
+            wordsCase.board = &boards[generator.Range(0, boards.size() - 1)];
+            for (size_t i = generator.Range(1, 5); i > 0; --i)
+                wordsCase.letters.push_back(RandomWord(generator, generator.Range(Dictionary::MIN_WORD_SIZE, std::min<size_t>(5, std::max(wordsCase.board->Rows(), wordsCase.board->Cols())))));
+
+            wordsCase.words.assign(std::begin(wordsCase.letters), std::end(wordsCase.letters));
+        }
+
+        results.push_back(Compare("IsAnyWordDuplicated", wordsCases.size(),
+            [&](size_t i) { return WordSearch::IsAnyWordDuplicated(*wordsCases[i].board, wordsCases[i].words, getCandidates(*wordsCases[i].board)); },
+            [&](size_t i)
+            {
+                auto counts = WordSearch::WordFinder(wordsCases[i].words).Count(*wordsCases[i].board);
+                return std::any_of(std::begin(counts), std::end(counts), [](size_t count) { return count > 1; });
+            },
+            equal));
+
+        // few words placed one after another, candidates overlapping them are removed
+        struct RemoveCase
+        {
+            const WordSearch::Board* board;
+            std::vector<std::tuple<WordSearch::Candidate, size_t>> placed;
+        };
+
+        std::vector<RemoveCase> removeCases(iterations / 64 + 1);
+        for (auto& removeCase : removeCases)
+        {
+            removeCase.board = &boards[generator.Range(0, boards.size() - 1)];
+            for (size_t i = generator.Range(1, 6); i > 0; --i)
+            {
+                size_t size = RandomWordSize(generator, *removeCase.board);
+                const auto& sized = getCandidates(*removeCase.board)[size];
+                removeCase.placed.push_back({ sized[generator.Range(0, sized.size() - 1)], size });
+            }
+        }
+
+        results.push_back(Compare("RemoveInterceptingCandidates", removeCases.size(),
+            [&](size_t i)
+            {
+                auto table = WordSearch::GetCandidateTable(removeCases[i].board->Rows(), removeCases[i].board->Cols());
+                auto result = table->candidates;
+
+                for (const auto& [position, size] : removeCases[i].placed)
+                    WordSearch::RemoveInterceptingCandidates(position, size, result);
+
+                return result;
+            },
+            [&](size_t i)
+            {
+                WordSearch::CandidateView result(WordSearch::GetCandidateTable(removeCases[i].board->Rows(), removeCases[i].board->Cols()));
+
+                for (const auto& [position, size] : removeCases[i].placed)
+                    result.RemoveIntercepting(*removeCases[i].board, position, size);
+
+                return result;
+            },
+            [](const WordSearch::ProcessedCandidates& expected, WordSearch::CandidateView& actual)
+            {
+                for (size_t dir = 0; dir < (size_t)WordSearch::Direction::COUNT; ++dir)
+                {
+                    for (size_t size = Dictionary::MIN_WORD_SIZE; size < Dictionary::MAX_WORD_SIZE; ++size)
+                    {
+                        auto next = std::begin(expected[dir][size]);
+
+                        for (auto index : actual.Live((WordSearch::Direction)dir, size))
+                        {
+                            if (!actual.IsLive((WordSearch::Direction)dir, size, index))
+                                continue;
+
+                            const auto& candidate = actual.Get((WordSearch::Direction)dir, size, index);
+                            if (next == std::end(expected[dir][size]) || next->row != candidate.row || next->col != candidate.col || next->dir != candidate.dir)
+                                return false;
+
+                            ++next;
+                        }
+
+                        if (next != std::end(expected[dir][size]))
+                            return false;
+                    }
+                }
+
+                return true;
+            }));
+
+        return results;
+    }
+
+    bool PrintDifferential(const std::vector<DifferentialResult>& results, std::ostream& output)
+    {
+        bool result = true;
+
+        output << "pair                            cases  mismatches  reference ms    fast ms  speedup\n";
+        for (const auto& pair : results)
+        {
+            output << std::left << std::setw(28) << pair.name << std::right
+                << std::setw(9) << pair.cases
+                << std::setw(12) << pair.mismatches
+                << std::fixed << std::setprecision(2)
+                << std::setw(14) << std::chrono::duration<double, std::milli>(pair.referenceTime).count()
+                << std::setw(11) << std::chrono::duration<double, std::milli>(pair.fastTime).count()
+                << std::setw(8) << std::setprecision(1) << pair.Speedup() << "x\n";
+
+            result = result && pair.mismatches == 0;
+        }
+
+        return result;
+    }
+}
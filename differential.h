@@ -0,0 +1,29 @@
+#pragma once
+#include <vector>
+#include <chrono>
+#include <ostream>
+#include <cstdint>
+
+namespace Test
+{
+    // Reference implementation and its fast replacement run on the same inputs.
+    struct DifferentialResult
+    {
+        const char* name = "";
+        size_t cases = 0;
+        // cases where results differ
+        size_t mismatches = 0;
+
+        std::chrono::nanoseconds referenceTime{ 0 };
+        std::chrono::nanoseconds fastTime{ 0 };
+
+        double Speedup() const;
+    };
+
+    // Generate random boards, candidates and words from seed, run them through each pair and
+    // compare every result. Results are checked without assert, so it works in release builds.
+    std::vector<DifferentialResult> RunDifferential(uint64_t seed, size_t iterations);
+
+    // Print table of cases, mismatches and speedups, return false if some pair disagreed.
+    bool PrintDifferential(const std::vector<DifferentialResult>& results, std::ostream& output);
+}
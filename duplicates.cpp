@@ -0,0 +1,245 @@
+#include "duplicates.h"
+
+namespace WordSearch
+{
+    DuplicateDetector::DuplicateDetector(const Board& board, const Words& words)
+        : m_words(words), m_automaton(words), m_mainCount(words.size()), m_tracked(words.size(), 1)
+    {
+        for (size_t i = 0; i < words.size(); ++i)
+            m_ids.emplace(words[i], (uint32_t)i);
+
+        CountLines(board);
+    }
+
+    void DuplicateDetector::AddWord(const Board& board, std::string_view word, const Candidate& position)
+    {
+        if (auto id = m_ids.find(word); id != std::end(m_ids))
+        {
+            m_tracked[id->second] = 1;
+            Update(board, position, word.size());
+            return;
+        }
+
+        m_ids.emplace(word, (uint32_t)m_words.size());
+        m_tracked.push_back(1);
+        m_words.push_back(word);
+        m_counts.push_back(0);
+        m_deltas.push_back(0);
+
+        if (m_words.size() - m_mainCount > RECENT_WORDS)
+        {
+            m_automaton = WordAutomaton(m_words);
+            m_recentAutomaton = WordAutomaton();
+            m_mainCount = m_words.size();
+        }
+        else
+        {
+            m_recentAutomaton = WordAutomaton(Words(std::begin(m_words) + m_mainCount, std::end(m_words)));
+        }
+
+        // word was not on board before, so it occurs only on lines going through its cells
+        Update(board, position, word.size());
+    }
+
+    template<class T>
+    void DuplicateDetector::ScanLine(const uint8_t* cells, const Line& line, T function) const
+    {
+        m_automaton.Scan(cells, line, [&function](uint32_t word, size_t) { function(word); });
+        m_recentAutomaton.Scan(cells, line, [this, &function](uint32_t word, size_t) { function((uint32_t)(m_mainCount + word)); });
+    }
+
+    void DuplicateDetector::AddPair(PairBits& bits, uint8_t first, uint8_t second)
+    {
+        size_t bit = ((size_t)first * 31 + second) % (bits.size() * 64);
+        bits[bit / 64] |= 1ull << (bit % 64);
+    }
+
+    DuplicateDetector::PairBits DuplicateDetector::GetPairBits(const uint8_t* cells, const Line& line)
+    {
+        PairBits result{};
+        ptrdiff_t index = (ptrdiff_t)line.start;
+        uint8_t previous = 0;
+
+        for (size_t i = 0; i < line.length; ++i, index += line.stride)
+        {
+            if (previous != 0 && cells[index] != 0)
+                AddPair(result, previous, cells[index]);
+
+            previous = cells[index];
+        }
+
+        return result;
+    }
+
+    void DuplicateDetector::CountLine(const Board& board, size_t line)
+    {
+        auto boardLine = board.GetLine(line);
+
+        for (auto word : m_lineMatches[line])
+            m_counts[word]--;
+        m_lineMatches[line].clear();
+
+        ScanLine(board.Data(), boardLine, [this, line](uint32_t word)
+            {
+                m_lineMatches[line].push_back(word);
+                m_counts[word]++;
+            });
+
+        m_linePairs[line] = GetPairBits(board.Data(), boardLine);
+    }
+
+    void DuplicateDetector::CountLines(const Board& board)
+    {
+        m_lineMatches.assign(board.LineCount(), {});
+        m_linePairs.assign(board.LineCount(), {});
+        m_lineMarks.assign(board.LineCount(), 0);
+        m_counts.assign(m_words.size(), 0);
+        m_deltas.assign(m_words.size(), 0);
+
+        for (size_t line = 0; line < board.LineCount(); ++line)
+            CountLine(board, line);
+    }
+
+    void DuplicateDetector::MarkLines(const Board& board, size_t index)
+    {
+        for (auto line : board.GetCellLines(index / board.Cols(), index % board.Cols()))
+        {
+            if (m_lineMarks[line])
+                continue;
+
+            m_lineMarks[line] = 1;
+            m_lines.push_back(line);
+        }
+    }
+
+    void DuplicateDetector::Update(const Board& board, const Candidate& position, size_t size)
+    {
+        ptrdiff_t index = (ptrdiff_t)board.Index(position.row, position.col);
+        for (size_t i = 0; i < size; ++i, index += board.Stride(position.dir))
+            MarkLines(board, (size_t)index);
+
+        for (auto line : m_lines)
+        {
+            CountLine(board, line);
+            m_lineMarks[line] = 0;
+        }
+        m_lines.clear();
+    }
+
+    void DuplicateDetector::RemoveWord(const Board& board, std::string_view word, const Candidate& position)
+    {
+        if (auto id = m_ids.find(word); id != std::end(m_ids))
+            m_tracked[id->second] = 0;
+
+        Update(board, position, word.size());
+    }
+
+    bool DuplicateDetector::IsAnyWordDuplicated() const
+    {
+        for (size_t word = 0; word < m_counts.size(); ++word)
+        {
+            if (m_tracked[word] && m_counts[word] > 1)
+                return true;
+        }
+
+        return false;
+    }
+
+    bool DuplicateDetector::SetPendingWord(const Board& board, std::string_view word)
+    {
+        m_pendingWord = word;
+        m_pendingAutomaton = WordAutomaton({ word });
+
+        // line can contain word (in either direction) only if it has all of its letter pairs
+        PairBits forward{}, reversed{};
+        for (size_t i = 0; i + 1 < word.size(); ++i)
+        {
+            AddPair(forward, (uint8_t)word[i], (uint8_t)word[i + 1]);
+            AddPair(reversed, (uint8_t)word[i + 1], (uint8_t)word[i]);
+        }
+
+        auto hasPairs = [](const PairBits& line, const PairBits& pairs)
+        {
+            for (size_t i = 0; i < pairs.size(); ++i)
+            {
+                if ((line[i] & pairs[i]) != pairs[i])
+                    return false;
+            }
+
+            return true;
+        };
+
+        size_t count = 0;
+        for (size_t line = 0; line < m_linePairs.size() && count == 0; ++line)
+        {
+            if (hasPairs(m_linePairs[line], forward) || hasPairs(m_linePairs[line], reversed))
+                m_pendingAutomaton.Scan(board.Data(), board.GetLine(line), [&count](uint32_t, size_t) { count++; });
+        }
+
+        return count == 0;
+    }
+
+    bool DuplicateDetector::VerifyPlacement(Board& board, const Candidate& position)
+    {
+        auto cells = board.Data();
+        bool result = true;
+
+        // temporarily write pending word to empty cells
+        ptrdiff_t index = (ptrdiff_t)board.Index(position.row, position.col);
+        for (size_t i = 0; i < m_pendingWord.size(); ++i, index += board.Stride(position.dir))
+        {
+            if (cells[index] != 0)
+            {
+                result = result && cells[index] == (uint8_t)m_pendingWord[i];
+                continue;
+            }
+
+            board.Set((size_t)index, (uint8_t)m_pendingWord[i]);
+            m_changedCells.push_back((size_t)index);
+        }
+
+        for (auto cell : m_changedCells)
+            MarkLines(board, cell);
+
+        // pending word was not present before, so all of its occurrences are on changed lines
+        size_t pendingCount = 0;
+
+        for (auto line : m_lines)
+        {
+            auto boardLine = board.GetLine(line);
+
+            for (auto word : m_lineMatches[line])
+            {
+                m_deltas[word]--;
+                m_deltaWords.push_back(word);
+            }
+
+            ScanLine(cells, boardLine, [this](uint32_t word)
+                {
+                    m_deltas[word]++;
+                    m_deltaWords.push_back(word);
+                });
+            m_pendingAutomaton.Scan(cells, boardLine, [&pendingCount](uint32_t, size_t) { pendingCount++; });
+
+            m_lineMarks[line] = 0;
+        }
+
+        result = result && pendingCount <= 1;
+
+        for (auto word : m_deltaWords)
+        {
+            if (m_tracked[word] && (int)m_counts[word] + m_deltas[word] > 1)
+                result = false;
+            m_deltas[word] = 0;
+        }
+
+        for (auto cell : m_changedCells)
+            board.Set(cell, 0);
+
+        m_changedCells.clear();
+        m_lines.clear();
+        m_deltaWords.clear();
+
+        return result;
+    }
+}
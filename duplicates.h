@@ -0,0 +1,85 @@
+#pragma once
+#include <vector>
+#include <array>
+#include <string>
+#include <unordered_map>
+#include "wordSearch.h"
+#include "automaton.h"
+
+namespace WordSearch
+{
+    // Tracks number of occurrences of placed words on board. Occurrences are kept per board line
+    // (rows, columns, diagonals and anti-diagonals), so after a change only lines going through
+    // changed cells are scanned again.
+    class DuplicateDetector
+    {
+    public:
+        DuplicateDetector() = default;
+        DuplicateDetector(const Board& board, const Words& words);
+
+        // Start tracking word just placed on position, it must not have been on board before (see
+        // SetPendingWord), so only lines of its cells are counted again.
+        void AddWord(const Board& board, std::string_view word, const Candidate& position);
+        // Stop tracking word removed from position, after its cells were cleared. Its occurrences
+        // are still counted, so adding it again does not grow automatons.
+        void RemoveWord(const Board& board, std::string_view word, const Candidate& position);
+        // Count again lines going through cells of word of size on position, after board changed there.
+        void Update(const Board& board, const Candidate& position, size_t size);
+
+        size_t GetCount(size_t word) const { return m_counts[word]; }
+        // Only tracked words are checked.
+        bool IsAnyWordDuplicated() const;
+
+        // Set word which placements will be verified. Return false if word is already present on board,
+        // in which case any new placement would duplicate it. Only lines having all letter pairs of
+        // word are scanned.
+        bool SetPendingWord(const Board& board, std::string_view word);
+        // Check if placing pending word on position keeps tracked words and pending word unique.
+        // Board is modified during the check and restored before return.
+        bool VerifyPlacement(Board& board, const Candidate& position);
+
+    private:
+        // bit of each pair of neighbouring letters (hashed) occurring on line
+        using PairBits = std::array<uint64_t, 4>;
+
+        // Words added one by one go to small recent automaton, all words are compiled into main
+        // automaton once recent one has this many, so adding a word does not rebuild all of them.
+        static constexpr size_t RECENT_WORDS = 32;
+
+        void CountLines(const Board& board);
+        void CountLine(const Board& board, size_t line);
+        void MarkLines(const Board& board, size_t index);
+
+        // Call function(word) for each occurrence of tracked word on line.
+        template<class T>
+        void ScanLine(const uint8_t* cells, const Line& line, T function) const;
+
+        static PairBits GetPairBits(const uint8_t* cells, const Line& line);
+        static void AddPair(PairBits& bits, uint8_t first, uint8_t second);
+
+        Words m_words;
+        // main automaton has first m_mainCount words, recent one the rest
+        WordAutomaton m_automaton;
+        WordAutomaton m_recentAutomaton;
+        size_t m_mainCount = 0;
+
+        // matched words and letter pairs on each line and total count of each word
+        std::vector<std::vector<uint32_t>> m_lineMatches;
+        std::vector<PairBits> m_linePairs;
+        std::vector<size_t> m_counts;
+
+        // id of each word ever added, removed words stay counted but they are not tracked
+        std::unordered_map<std::string_view, uint32_t> m_ids;
+        std::vector<uint8_t> m_tracked;
+
+        std::string_view m_pendingWord;
+        WordAutomaton m_pendingAutomaton;
+
+        // scratch buffers for verification
+        std::vector<size_t> m_changedCells;
+        std::vector<size_t> m_lines;
+        std::vector<uint8_t> m_lineMarks;
+        std::vector<int> m_deltas;
+        std::vector<uint32_t> m_deltaWords;
+    };
+}
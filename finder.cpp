@@ -0,0 +1,93 @@
+#include "finder.h"
+#include "candidates.h"
+#include <algorithm>
+
+namespace WordSearch
+{
+    // Direction of increasing positions on lines of each kind (see Board::GetCellLines).
+    static constexpr Direction FORWARD_DIRECTIONS[] = { Direction::Right, Direction::Down, Direction::DownRight, Direction::DownLeft };
+
+    // Index into Board::GetCellLines of kind of line with number line.
+    size_t GetLineKind(const Board& board, size_t line)
+    {
+        size_t diagonals = board.Rows() + board.Cols() - 1;
+
+        if (line < board.Rows())
+            return 0;
+        if (line < board.Rows() + board.Cols())
+            return 1;
+
+        return line < board.Rows() + board.Cols() + diagonals ? 2 : 3;
+    }
+
+    WordFinder::WordFinder(const Words& words)
+        : m_automaton(words)
+    {
+    }
+
+    template<class T>
+    void WordFinder::Scan(const Board& board, T function) const
+    {
+        if (m_automaton.WordCount() == 0)
+            return;
+
+        for (size_t line = 0; line < board.LineCount(); ++line)
+        {
+            auto boardLine = board.GetLine(line);
+            size_t kind = GetLineKind(board, line);
+            auto cells = board.Span(boardLine.start / board.Cols(), boardLine.start % board.Cols(), FORWARD_DIRECTIONS[kind]);
+
+            WordAutomaton::State state = 0;
+            for (size_t i = 0; i < boardLine.length; ++i)
+            {
+                state = m_automaton.Next(state, cells[i]);
+
+                for (auto it = m_automaton.MatchesBegin(state); it != m_automaton.MatchesEnd(state); ++it)
+                    function(*it, m_automaton.IsReversed(it), boardLine, kind, i);
+            }
+        }
+    }
+
+    std::vector<Occurrence> WordFinder::Find(const Board& board) const
+    {
+        std::vector<Occurrence> result;
+
+        Scan(board, [&](uint32_t word, bool reversed, const Line& line, size_t kind, size_t position)
+            {
+                // reversed word is read backwards from last matched cell
+                size_t first = reversed ? position : position + 1 - m_automaton.WordSize(word);
+                size_t cell = (size_t)((ptrdiff_t)line.start + (ptrdiff_t)first * line.stride);
+                auto dir = reversed ? GetOpositeDirection(FORWARD_DIRECTIONS[kind]) : FORWARD_DIRECTIONS[kind];
+
+                result.push_back({ word, { (int)(cell / board.Cols()), (int)(cell % board.Cols()), dir } });
+            });
+
+        return result;
+    }
+
+    std::vector<size_t> WordFinder::Count(const Board& board) const
+    {
+        std::vector<size_t> result(m_automaton.WordCount(), 0);
+
+        Scan(board, [&result](uint32_t word, bool, const Line&, size_t, size_t) { result[word]++; });
+
+        return result;
+    }
+
+    bool WordFinder::IsValid(const Board& board) const
+    {
+        auto counts = Count(board);
+
+        return std::all_of(std::begin(counts), std::end(counts), [](size_t count) { return count == 1; });
+    }
+
+    std::vector<Occurrence> FindOccurrences(const Board& board, const Words& words)
+    {
+        return WordFinder(words).Find(board);
+    }
+
+    std::vector<size_t> CountOccurrences(const Board& board, const Words& words)
+    {
+        return WordFinder(words).Count(board);
+    }
+}
@@ -0,0 +1,42 @@
+#pragma once
+#include <vector>
+#include "wordSearch.h"
+#include "automaton.h"
+
+namespace WordSearch
+{
+    struct Occurrence
+    {
+        // index into words
+        uint32_t word;
+        // first letter and reading direction
+        Candidate position;
+    };
+
+    // Finds words of a finished puzzle in all eight directions. Automaton over words and their
+    // reversals is built once, each board line is then scanned once (in its contiguous mirror,
+    // see Board::Mirror), which finds occurrences in both directions of the line. Finder can be
+    // reused for many boards with the same words.
+    class WordFinder
+    {
+    public:
+        explicit WordFinder(const Words& words);
+
+        std::vector<Occurrence> Find(const Board& board) const;
+        // Number of occurrences of each word. Palindrome is found in both directions, so it is
+        // counted twice for each occurrence and it is never unique.
+        std::vector<size_t> Count(const Board& board) const;
+        // Every word occurs exactly once.
+        bool IsValid(const Board& board) const;
+
+    private:
+        // Call function(word, reversed, line, line kind, position of last matched letter) for each match.
+        template<class T>
+        void Scan(const Board& board, T function) const;
+
+        WordAutomaton m_automaton;
+    };
+
+    std::vector<Occurrence> FindOccurrences(const Board& board, const Words& words);
+    std::vector<size_t> CountOccurrences(const Board& board, const Words& words);
+}
@@ -0,0 +1,309 @@
+#include "improve.h"
+#include "duplicates.h"
+#include "finder.h"
+#include "candidates.h"
+#include <array>
+#include <cmath>
+#include <algorithm>
+
+namespace WordSearch
+{
+    std::tuple<int, int> GetEndpoint(const Candidate& candidate, size_t size);
+    bool IsInterceptingCandidate(const Candidate& candidate1, size_t size1, const Candidate& candidate2, size_t size2);
+
+    using Clock = std::chrono::steady_clock;
+
+    // Slots through one empty cell compared by an attempt, the one reusing most letters is tried first.
+    static constexpr size_t SLOT_CHOICES = 4;
+
+    // Words on board with their positions and number of words covering each cell, so cells of
+    // removed word which no other word uses are known without rescanning the board. Duplicate
+    // detector and list of empty cells are updated by each change, changes of a move are
+    // journaled, so rejected move is undone in place.
+    struct Layout
+    {
+        Board board;
+        Words words;
+        std::vector<Candidate> positions;
+        std::vector<uint8_t> coverage;
+
+        DuplicateDetector duplicates;
+        // may contain cells covered since they were added, they are dropped when picked
+        std::vector<size_t> empty;
+        std::vector<uint8_t> emptyMarks;
+
+        // words added (true) and removed since last Commit
+        std::vector<std::tuple<bool, std::string_view, Candidate>> journal;
+
+        Layout(const Board& board, const Words& words, const std::vector<Candidate>& positions)
+            : board(board), words(words), positions(positions), coverage(board.CellCount()), emptyMarks(board.CellCount())
+        {
+            for (size_t i = 0; i < words.size(); ++i)
+                ForEachCell(positions[i], words[i].size(), [&](size_t cell) { coverage[cell]++; });
+
+            for (size_t cell = 0; cell < board.CellCount(); ++cell)
+                MarkEmpty(cell);
+        }
+
+        // Start tracking duplicates, once layout is known to be valid.
+        void Track()
+        {
+            duplicates = DuplicateDetector(board, words);
+        }
+
+        size_t Covered() const { return board.CellCount() - board.FreeCellCount(); }
+
+        // Call function(cell index) for each cell of word of size on position.
+        template<class T>
+        void ForEachCell(const Candidate& position, size_t size, T function) const
+        {
+            auto index = (ptrdiff_t)board.Index(position.row, position.col);
+            for (size_t i = 0; i < size; ++i, index += board.Stride(position.dir))
+                function((size_t)index);
+        }
+
+        void MarkEmpty(size_t cell)
+        {
+            if (coverage[cell] != 0 || emptyMarks[cell])
+                return;
+
+            emptyMarks[cell] = 1;
+            empty.push_back(cell);
+        }
+
+        void Remove(size_t word)
+        {
+            auto removed = words[word];
+            auto position = positions[word];
+
+            ForEachCell(position, removed.size(), [&](size_t cell)
+                {
+                    if (--coverage[cell] == 0)
+                    {
+                        board.Set(cell, 0);
+                        MarkEmpty(cell);
+                    }
+                });
+
+            words[word] = words.back();
+            words.pop_back();
+            positions[word] = positions.back();
+            positions.pop_back();
+
+            duplicates.RemoveWord(board, removed, position);
+            journal.emplace_back(false, removed, position);
+        }
+
+        void Add(const Candidate& position, std::string_view word)
+        {
+            size_t i = 0;
+            ForEachCell(position, word.size(), [&](size_t cell)
+                {
+                    board.Set(cell, (uint8_t)word[i++]);
+                    coverage[cell]++;
+                });
+
+            words.push_back(word);
+            positions.push_back(position);
+
+            duplicates.AddWord(board, word, position);
+            journal.emplace_back(true, word, position);
+        }
+
+        void Commit()
+        {
+            journal.clear();
+        }
+
+        // Revert changes since last Commit. Words added by the move are the last ones, removed
+        // words are added back (at the end of words).
+        void Undo()
+        {
+            auto changes = std::move(journal);
+
+            for (auto change = changes.rbegin(); change != changes.rend(); ++change)
+            {
+                const auto& [added, word, position] = *change;
+                if (added)
+                    Remove(words.size() - 1);
+                else
+                    Add(position, word);
+            }
+
+            journal.clear();
+        }
+
+        // Word of size on position does not overlap other word on the same line (in same or
+        // opposite direction), as placement of PositionWords never does.
+        bool IsFree(const Candidate& position, size_t size) const
+        {
+            for (size_t i = 0; i < positions.size(); ++i)
+            {
+                bool sameLine = positions[i].dir == position.dir || positions[i].dir == GetOpositeDirection(position.dir);
+                if (sameLine && IsInterceptingCandidate(positions[i], words[i].size(), position, size))
+                    return false;
+            }
+
+            return true;
+        }
+    };
+
+    // Place words through random empty cells of layout.
+    void Repair(Random::Generator& generator, const Dictionary::PatternIndex& index, Layout& layout, const ImproveOptions& options, size_t minSize, size_t maxSize)
+    {
+        auto& board = layout.board;
+        auto& empty = layout.empty;
+
+        std::array<std::tuple<size_t, Candidate, size_t>, SLOT_CHOICES> slots;
+
+        for (size_t attempt = 0; attempt < options.attempts && !empty.empty(); ++attempt)
+        {
+            size_t pick = generator.Range(0, empty.size() - 1);
+            size_t cell = empty[pick];
+
+            if (layout.coverage[cell] != 0)
+            {
+                layout.emptyMarks[cell] = 0;
+                empty[pick] = empty.back();
+                empty.pop_back();
+                continue;
+            }
+
+            // slots of random direction and size with cell at random position
+            size_t slotCount = 0;
+            for (size_t i = 0; i < SLOT_CHOICES; ++i)
+            {
+                auto dir = (Direction)generator.Range(0, (size_t)Direction::COUNT - 1);
+                size_t size = generator.Range(minSize, maxSize);
+                int offset = (int)generator.Range(0, size - 1);
+
+                auto [rowStep, colStep] = GetEndpoint({ 0, 0, dir }, 2);
+                Candidate position{ (int)(cell / board.Cols()) - offset * rowStep, (int)(cell % board.Cols()) - offset * colStep, dir };
+                auto [endRow, endCol] = GetEndpoint(position, size);
+
+                if (std::min({ position.row, position.col, endRow, endCol }) < 0 || std::max(position.row, endRow) >= (int)board.Rows() || std::max(position.col, endCol) >= (int)board.Cols())
+                    continue;
+
+                if (!layout.IsFree(position, size))
+                    continue;
+
+                // kept sorted by empty cells, so slot reusing most letters is first
+                size_t emptyCount = board.CountEmpty(position.row, position.col, dir, size);
+                size_t j = slotCount++;
+                for (; j > 0 && std::get<0>(slots[j - 1]) > emptyCount; --j)
+                    slots[j] = slots[j - 1];
+
+                slots[j] = { emptyCount, position, size };
+            }
+
+            for (size_t i = 0; i < slotCount; ++i)
+            {
+                const auto& [emptyCount, position, size] = slots[i];
+                auto word = index.GetRandomMatch(generator, board.Span(position.row, position.col, position.dir), size);
+
+                if (!word || std::find(std::begin(layout.words), std::end(layout.words), *word) != std::end(layout.words))
+                    continue;
+
+                if (!layout.duplicates.SetPendingWord(board, *word) || !layout.duplicates.VerifyPlacement(board, position))
+                    continue;
+
+                layout.Add(position, *word);
+                break;
+            }
+        }
+    }
+
+    ImproveStats ImproveBoard(Random::Generator& generator, const Dictionary::PatternIndex& index, Board& board, Words& words, const ImproveOptions& options)
+    {
+        ImproveStats result;
+        result.coveredBefore = result.coveredAfter = board.CellCount() - board.FreeCellCount();
+
+        // positions of words, each must be found exactly once
+        std::vector<size_t> counts(words.size());
+        std::vector<Candidate> positions(words.size());
+        for (const auto& occurrence : WordFinder(words).Find(board))
+        {
+            counts[occurrence.word]++;
+            positions[occurrence.word] = occurrence.position;
+        }
+
+        if (std::any_of(std::begin(counts), std::end(counts), [](size_t count) { return count != 1; }))
+            return result;
+
+        Layout current(board, words, positions);
+
+        // letters which are not part of any word (board is already filled)
+        for (size_t cell = 0; cell < board.CellCount(); ++cell)
+        {
+            if ((current.coverage[cell] == 0) != (board.Data()[cell] == 0))
+                return result;
+        }
+
+        size_t minSize = std::max(options.wordSizeFrom, Dictionary::MIN_WORD_SIZE);
+        size_t maxSize = std::min({ options.wordSizeTo, Dictionary::MAX_WORD_SIZE - 1, std::max(board.Rows(), board.Cols()) });
+        if (minSize > maxSize)
+            return result;
+
+        current.Track();
+
+        bool timed = options.maxTime.count() != 0;
+        size_t iterations = options.iterations;
+        if (iterations == 0)
+            iterations = timed ? SIZE_MAX : ImproveOptions().iterations;
+        auto start = Clock::now();
+
+        // best board reached, copied only when it improves
+        Board bestBoard = board;
+        Words bestWords = words;
+        size_t bestCovered = current.Covered();
+
+        // nothing to gain once every cell is covered
+        for (; result.iterations < iterations && bestCovered < board.CellCount(); ++result.iterations)
+        {
+            // annealing temperature falls with used share of iterations or time, whichever is larger
+            double progress = iterations != SIZE_MAX ? (double)result.iterations / iterations : 0;
+            if (timed)
+            {
+                auto elapsed = Clock::now() - start;
+                if (elapsed >= options.maxTime)
+                    break;
+
+                progress = std::max(progress, std::chrono::duration<double>(elapsed) / options.maxTime);
+            }
+
+            size_t covered = current.Covered();
+            for (size_t i = generator.Range(1, std::max<size_t>(options.maxRemoved, 1)); i > 0 && !current.words.empty(); --i)
+                current.Remove(generator.Range(0, current.words.size() - 1));
+
+            Repair(generator, index, current, options, minSize, maxSize);
+
+            double delta = (double)current.Covered() - (double)covered;
+            double temperature = options.temperature * (1 - progress);
+            // uniform value from [0, 1)
+            double random = (double)(generator() >> 11) / (double)(1ull << 53);
+
+            if (delta >= 0 || (temperature > 0 && random < std::exp(delta / temperature)))
+            {
+                current.Commit();
+                result.acceptedMoves++;
+
+                if (current.Covered() > bestCovered)
+                {
+                    bestBoard = current.board;
+                    bestWords = current.words;
+                    bestCovered = current.Covered();
+                }
+            }
+            else
+            {
+                current.Undo();
+            }
+        }
+
+        board = std::move(bestBoard);
+        words = std::move(bestWords);
+        result.coveredAfter = bestCovered;
+
+        return result;
+    }
+}
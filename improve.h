@@ -0,0 +1,40 @@
+#pragma once
+#include <chrono>
+#include "wordSearch.h"
+
+namespace WordSearch
+{
+    struct ImproveOptions
+    {
+        // search stops after iterations or time, zero means not set (iterations are used if neither is)
+        size_t iterations = 200;
+        std::chrono::milliseconds maxTime{ 0 };
+
+        size_t wordSizeFrom = Dictionary::MIN_WORD_SIZE;
+        size_t wordSizeTo = Dictionary::MAX_WORD_SIZE;
+        // words removed by one move, at least one
+        size_t maxRemoved = 3;
+        // placement attempts of one move, each through a random empty cell
+        size_t attempts = 100;
+        // initial temperature of annealing (in covered cells), it decreases linearly to 0 and
+        // 0 accepts only moves which do not lose covered cells
+        double temperature = 1.0;
+    };
+
+    struct ImproveStats
+    {
+        size_t iterations = 0;
+        size_t acceptedMoves = 0;
+        // cells covered by words before and after (best board reached is kept)
+        size_t coveredBefore = 0;
+        size_t coveredAfter = 0;
+    };
+
+    // Make board of PositionWords denser by large neighbourhood search. Move removes a few random
+    // words (cells used only by them become empty) and places new words through empty cells,
+    // preferring slots which reuse most letters already on board; words for slots are drawn from
+    // index. Covered cells are kept up to date on every change, so a move is scored by their
+    // difference. Board must not be filled with random letters yet and every word must occur
+    // on it exactly once, otherwise it is left as it is. Returned words point to data of index.
+    ImproveStats ImproveBoard(Random::Generator& generator, const Dictionary::PatternIndex& index, Board& board, Words& words, const ImproveOptions& options = {});
+}
@@ -1,39 +1,102 @@
 #include "test.h"
 #include "dictionary.h"
+#include "alphabet.h"
 #include "wordSearch.h"
+#include "batch.h"
+#include "service.h"
 #include <iostream>
+#include <cstring>
+#include <cstdio>
+#include <algorithm>
 
-int main()
+// wordsearch-generator --serve name=path... [--socket path] [--threads n] [--warm rows,cols]
+int Serve(int argc, char* argv[])
 {
+    WordSearch::Service service;
+    std::string socketPath;
+    size_t threadCount = 0;
+
+    for (int i = 2; i < argc; ++i)
+    {
+        std::string argument = argv[i];
+        size_t rows = 0, cols = 0;
+
+        if (argument == "--socket" && i + 1 < argc)
+            socketPath = argv[++i];
+        else if (argument == "--threads" && i + 1 < argc)
+            threadCount = std::strtoul(argv[++i], nullptr, 10);
+        else if (argument == "--warm" && i + 1 < argc && std::sscanf(argv[++i], "%zu,%zu", &rows, &cols) == 2)
+            service.Warm(rows, cols);
+        else if (auto separator = argument.find('='); separator != std::string::npos && service.AddDictionary(argument.substr(0, separator), argument.substr(separator + 1)))
+            continue;
+        else
+        {
+            std::cerr << "Invalid argument: " << argument << "\n";
+            return 1;
+        }
+    }
+
+    if (socketPath.empty())
+    {
+        service.Serve(std::cin, std::cout, threadCount);
+        return 0;
+    }
+
+    if (!service.ServeSocket(socketPath, threadCount))
+    {
+        std::cerr << "Can't listen on " << socketPath << "\n";
+        return 1;
+    }
+
+    return 0;
+}
+
+int main(int argc, char* argv[])
+{
+    if (argc > 1 && std::strcmp(argv[1], "--serve") == 0)
+        return Serve(argc, argv);
+
     Test::Execute();
 
-    auto data = Dictionary::ReadDictionary("dict\\cz.txt");
+    // words are stored encoded by alphabet of dictionary, so letters with diacritics are one cell
+    Dictionary::Alphabet alphabet;
+    auto data = Dictionary::ReadDictionary("dict\\cz.txt", alphabet);
+    if (std::all_of(std::begin(data), std::end(data), [](const auto& words) { return words.Count() == 0; }))
+    {
+        std::cerr << "Dictionary dict\\cz.txt is missing or empty\n";
+        return 1;
+    }
 
-    // Backtracking implementation is slow.
-    //auto words1 = Dictionary::GetRandomWords(data, 6, 4, 6);
-    //if (auto board1 = WordSearch::PositionWords(6, 6, words1))
-    //{
-    //    WordSearch::PrintBoard(*board1);
-    //    for (const auto& word : words1)
-    //        std::cout << word << "\n";
-    //}
+    Random::Generator generator(Random::GetRandomSeed());
+    auto letters = WordSearch::GetLetterDistribution(data);
 
-    auto [board2, words2] = WordSearch::PositionWords(data, 10, 10, 4);
+    auto words1 = Dictionary::GetRandomWords(generator, data, 6, 4, 6);
+    if (auto board1 = words1 ? WordSearch::PositionWords(generator, 6, 6, *words1, { 100000, std::chrono::milliseconds(1000) }) : std::nullopt)
+    {
+        WordSearch::PrintBoard(*board1, &alphabet);
+        for (const auto& word : *words1)
+            std::cout << alphabet.Decode(word) << "\n";
+    }
+
+    auto [board2, words2] = WordSearch::PositionWords(generator, data, 10, 10, 4);
     std::cout << "Free cells: " << WordSearch::GetFreeCellsCount(board2) << "\n";
-    WordSearch::PrintBoard(board2);
+    WordSearch::PrintBoard(board2, &alphabet);
 
-    WordSearch::FillFreeCellsRandom(board2, words2);
+    WordSearch::FillFreeCellsRandom(generator, board2, words2, letters);
 
-    WordSearch::PrintBoard(board2);
+    WordSearch::PrintBoard(board2, &alphabet);
     for (const auto& word : words2)
-        std::cout << word << "\n";
+        std::cout << alphabet.Decode(word) << "\n";
+
+    WordSearch::BatchOptions options;
+    options.wordSizeFrom = 4;
+    options.fill = false;
 
     size_t freeCells = 0, wordCount = 0;
-    for (size_t i = 0; i < 100; ++i)
+    for (const auto& puzzle : WordSearch::GeneratePuzzles(data, 100, options))
     {
-        auto [board3, words3] = WordSearch::PositionWords(data, 10, 10, 4);
-        freeCells += WordSearch::GetFreeCellsCount(board3);
-        wordCount += words3.size();
+        freeCells += WordSearch::GetFreeCellsCount(puzzle.board);
+        wordCount += puzzle.words.size();
     }
     std::cout << "Average free cells: " << freeCells / 100 << "\n";
     std::cout << "Average word count: " << wordCount / 100 << "\n";
@@ -0,0 +1,79 @@
+#pragma once
+#include <cstdint>
+#include <cstddef>
+#include <cstring>
+#include <string_view>
+#include <vector>
+#include "board.h"
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define WORDSEARCH_SSE2
+#include <emmintrin.h>
+#endif
+
+namespace WordSearch
+{
+    // Result of comparing word with span of cells, empty cell (0) is a wildcard.
+    struct SpanMatch
+    {
+        // every cell is empty or equal to letter of word
+        bool fits;
+        // every cell is equal to letter of word
+        bool equal;
+        size_t emptyCount;
+    };
+
+    // Compare size letters with contiguous cells (see Board::Span). Both cells and letters must be
+    // readable in whole 16 byte blocks covering size.
+    inline SpanMatch MatchSpan(const uint8_t* cells, const uint8_t* letters, size_t size)
+    {
+        SpanMatch result{ true, true, 0 };
+
+#ifdef WORDSEARCH_SSE2
+        const __m128i zero = _mm_setzero_si128();
+
+        for (size_t i = 0; i < size; i += 16)
+        {
+            uint32_t valid = size - i >= 16 ? 0xffffu : (1u << (size - i)) - 1;
+
+            __m128i chunk = _mm_loadu_si128((const __m128i*)(cells + i));
+            uint32_t equal = (uint32_t)_mm_movemask_epi8(_mm_cmpeq_epi8(chunk, _mm_loadu_si128((const __m128i*)(letters + i)))) & valid;
+            uint32_t empty = (uint32_t)_mm_movemask_epi8(_mm_cmpeq_epi8(chunk, zero)) & valid;
+
+            result.fits = result.fits && (equal | empty) == valid;
+            result.equal = result.equal && equal == valid;
+            result.emptyCount += PopCount(empty);
+        }
+#else
+        for (size_t i = 0; i < size; ++i)
+        {
+            bool empty = cells[i] == 0;
+            bool equal = cells[i] == letters[i];
+
+            result.fits = result.fits && (empty || equal);
+            result.equal = result.equal && equal;
+            result.emptyCount += empty ? 1 : 0;
+        }
+#endif
+
+        return result;
+    }
+
+    // Word copied with padding to whole 16 byte blocks, prepared once and matched against many spans.
+    class WordPattern
+    {
+    public:
+        explicit WordPattern(std::string_view word)
+            : m_size(word.size()), m_letters((word.size() + 15) / 16 * 16, 0)
+        {
+            std::memcpy(m_letters.data(), word.data(), word.size());
+        }
+
+        size_t Size() const { return m_size; }
+        SpanMatch Match(const uint8_t* cells) const { return MatchSpan(cells, m_letters.data(), m_size); }
+
+    private:
+        size_t m_size;
+        std::vector<uint8_t> m_letters;
+    };
+}
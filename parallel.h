@@ -0,0 +1,55 @@
+#pragma once
+#include <thread>
+#include <atomic>
+#include <exception>
+#include <mutex>
+#include <vector>
+#include <algorithm>
+
+namespace WordSearch
+{
+    // Call function(i) for each i from [0, count) on a pool of threads, 0 threads means number of
+    // hardware threads. Items are taken one by one, so slow items do not stall whole thread's
+    // share. Calling thread works too. First exception thrown by function stops remaining items
+    // and it is rethrown to the caller.
+    template<class T>
+    void ParallelFor(size_t count, size_t threadCount, T function)
+    {
+        threadCount = threadCount != 0 ? threadCount : std::max(1u, std::thread::hardware_concurrency());
+        threadCount = std::min(threadCount, std::max<size_t>(count, 1));
+
+        std::atomic<size_t> next = 0;
+        std::exception_ptr error;
+        std::mutex errorMutex;
+
+        auto worker = [&]()
+        {
+            try
+            {
+                for (size_t i = next++; i < count; i = next++)
+                    function(i);
+            }
+            catch (...)
+            {
+                std::lock_guard<std::mutex> lock(errorMutex);
+                if (!error)
+                    error = std::current_exception();
+
+                // stop other threads
+                next = count;
+            }
+        };
+
+        std::vector<std::thread> threads;
+        for (size_t i = 1; i < threadCount; ++i)
+            threads.emplace_back(worker);
+
+        worker();
+
+        for (auto& thread : threads)
+            thread.join();
+
+        if (error)
+            std::rethrow_exception(error);
+    }
+}
@@ -0,0 +1,207 @@
+#include "pool.h"
+#include <tuple>
+#include <stdexcept>
+#include <algorithm>
+
+namespace WordSearch
+{
+    using Clock = std::chrono::steady_clock;
+
+    bool PoolKey::operator<(const PoolKey& other) const
+    {
+        return std::tie(rows, cols, wordSizeFrom, wordSizeTo, fill, placement) < std::tie(other.rows, other.cols, other.wordSizeFrom, other.wordSizeTo, other.fill, other.placement);
+    }
+
+    PuzzlePool::PuzzlePool(const Dictionary::Data& data, const PoolOptions& options, const Dictionary::PatternIndex* index)
+        : m_data(data), m_index(index), m_letters(GetLetterDistribution(data)), m_options(options), m_seed(options.seed ? *options.seed : Random::GetRandomSeed())
+    {
+        m_options.highWatermark = std::max(m_options.highWatermark, m_options.lowWatermark + 1);
+
+        size_t threadCount = options.threadCount != 0 ? options.threadCount : std::max(1u, std::thread::hardware_concurrency());
+        for (size_t i = 0; i < threadCount; ++i)
+            m_threads.emplace_back(&PuzzlePool::Worker, this);
+    }
+
+    PuzzlePool::~PuzzlePool()
+    {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_stop = true;
+        }
+        m_refill.notify_all();
+
+        for (auto& thread : m_threads)
+            thread.join();
+    }
+
+    void PuzzlePool::Add(const PoolKey& key)
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        GetEntry(key);
+    }
+
+    Puzzle PuzzlePool::Take(const PoolKey& key)
+    {
+        if (auto puzzle = TryTake(key))
+            return std::move(*puzzle);
+
+        uint64_t seed;
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            seed = Random::DeriveSeed(m_seed, m_next++);
+        }
+
+        Validate(key);
+        return GeneratePuzzle(m_data, seed, GetBatchOptions(key));
+    }
+
+    std::optional<Puzzle> PuzzlePool::TryTake(const PoolKey& key)
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        auto& entry = GetEntry(key);
+
+        if (entry.error)
+        {
+            auto error = entry.error;
+            entry.error = nullptr;
+            entry.refilling = true;
+            m_refill.notify_all();
+
+            std::rethrow_exception(error);
+        }
+
+        if (entry.ready.empty())
+        {
+            m_metrics.misses++;
+            return std::nullopt;
+        }
+
+        m_metrics.hits++;
+        Puzzle result = std::move(entry.ready.front());
+        entry.ready.pop_front();
+
+        if (!entry.refilling && entry.ready.size() <= m_options.lowWatermark)
+        {
+            entry.refilling = true;
+            m_refill.notify_all();
+        }
+
+        return result;
+    }
+
+    size_t PuzzlePool::Ready(const PoolKey& key) const
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        auto entry = m_entries.find(key);
+
+        return entry != std::end(m_entries) ? entry->second.ready.size() : 0;
+    }
+
+    PoolMetrics PuzzlePool::GetMetrics() const
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return m_metrics;
+    }
+
+    PuzzlePool::Entry& PuzzlePool::GetEntry(const PoolKey& key)
+    {
+        auto [entry, added] = m_entries.try_emplace(key);
+        if (added)
+            m_refill.notify_all();
+
+        return entry->second;
+    }
+
+    std::map<PoolKey, PuzzlePool::Entry>::iterator PuzzlePool::FindRefill()
+    {
+        auto result = std::end(m_entries);
+
+        for (auto entry = std::begin(m_entries); entry != std::end(m_entries); ++entry)
+        {
+            auto& [key, value] = *entry;
+            if (!value.refilling || value.ready.size() + value.pending >= m_options.highWatermark)
+                continue;
+
+            if (result == std::end(m_entries) || value.ready.size() + value.pending < result->second.ready.size() + result->second.pending)
+                result = entry;
+        }
+
+        return result;
+    }
+
+    void PuzzlePool::Validate(const PoolKey& key)
+    {
+        if (key.rows > MAX_POOL_BOARD_SIZE || key.cols > MAX_POOL_BOARD_SIZE)
+            throw std::invalid_argument("pooled board is too large");
+    }
+
+    BatchOptions PuzzlePool::GetBatchOptions(const PoolKey& key) const
+    {
+        BatchOptions result;
+        result.rows = key.rows;
+        result.cols = key.cols;
+        result.wordSizeFrom = key.wordSizeFrom;
+        result.wordSizeTo = key.wordSizeTo;
+        result.fill = key.fill;
+        result.letters = &m_letters;
+        result.policy.placement = key.placement;
+        result.policy.index = m_index;
+
+        return result;
+    }
+
+    void PuzzlePool::Worker()
+    {
+        std::unique_lock<std::mutex> lock(m_mutex);
+
+        while (!m_stop)
+        {
+            auto entry = FindRefill();
+            if (entry == std::end(m_entries))
+            {
+                m_refill.wait(lock);
+                continue;
+            }
+
+            // entries are never erased, so iterator stays valid while mutex is released
+            entry->second.pending++;
+            uint64_t seed = Random::DeriveSeed(m_seed, m_next++);
+            auto options = GetBatchOptions(entry->first);
+
+            lock.unlock();
+            auto start = Clock::now();
+            std::optional<Puzzle> puzzle;
+            std::exception_ptr error;
+            try
+            {
+                Validate(entry->first);
+                puzzle = GeneratePuzzle(m_data, seed, options);
+            }
+            catch (...)
+            {
+                error = std::current_exception();
+            }
+            auto time = Clock::now() - start;
+            lock.lock();
+
+            auto& value = entry->second;
+            value.pending--;
+
+            // failure is kept for Take, key is not refilled until then, so it does not fail repeatedly
+            if (error)
+            {
+                value.error = error;
+                value.refilling = false;
+                continue;
+            }
+
+            value.ready.push_back(std::move(*puzzle));
+            if (value.ready.size() >= m_options.highWatermark)
+                value.refilling = false;
+
+            m_metrics.refills++;
+            m_metrics.refillTime += time;
+            m_metrics.maxRefillTime = std::max<std::chrono::nanoseconds>(m_metrics.maxRefillTime, time);
+        }
+    }
+}
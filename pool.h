@@ -0,0 +1,116 @@
+#pragma once
+#include <map>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <condition_variable>
+#include <vector>
+#include <optional>
+#include <chrono>
+#include <exception>
+#include "batch.h"
+
+namespace WordSearch
+{
+    // Largest side of pooled board, puzzles of larger keys fail with std::invalid_argument.
+    static constexpr size_t MAX_POOL_BOARD_SIZE = 256;
+
+    // Generation parameters of pooled puzzles.
+    struct PoolKey
+    {
+        size_t rows = 10;
+        size_t cols = 10;
+        size_t wordSizeFrom = Dictionary::MIN_WORD_SIZE;
+        size_t wordSizeTo = Dictionary::MAX_WORD_SIZE;
+        bool fill = true;
+        Placement placement = Placement::Random;
+
+        bool operator<(const PoolKey& other) const;
+    };
+
+    struct PoolOptions
+    {
+        // refill of key starts when it has at most low ready puzzles and stops at high
+        size_t lowWatermark = 8;
+        size_t highWatermark = 32;
+        // background threads, 0 means number of hardware threads
+        size_t threadCount = 1;
+        // seed of all pooled puzzles, random if not set
+        std::optional<uint64_t> seed;
+    };
+
+    struct PoolMetrics
+    {
+        // Take served from ready puzzles / generated by caller
+        size_t hits = 0;
+        size_t misses = 0;
+
+        // puzzles generated in background and their generation time
+        size_t refills = 0;
+        std::chrono::nanoseconds refillTime{ 0 };
+        std::chrono::nanoseconds maxRefillTime{ 0 };
+    };
+
+    // Puzzles generated ahead of time by background threads, so taking one does not wait for
+    // generation and its long tail. Each key is kept between watermarks once it was added or
+    // taken. Puzzles are generated from seeds derived from pool seed, so each one is repeatable
+    // by GeneratePuzzle with its seed, but order of puzzles depends on timing of threads.
+    // Dictionary and index must outlive the pool.
+    class PuzzlePool
+    {
+    public:
+        explicit PuzzlePool(const Dictionary::Data& data, const PoolOptions& options = {}, const Dictionary::PatternIndex* index = nullptr);
+        ~PuzzlePool();
+
+        PuzzlePool(const PuzzlePool&) = delete;
+        PuzzlePool& operator=(const PuzzlePool&) = delete;
+
+        // Start filling key before it is first taken.
+        void Add(const PoolKey& key);
+
+        // Oldest ready puzzle of key, on miss it is generated by the caller. Exception thrown by
+        // background generation of key is rethrown (once) by the next Take or TryTake and refill of
+        // key is paused until then.
+        Puzzle Take(const PoolKey& key);
+        std::optional<Puzzle> TryTake(const PoolKey& key);
+
+        size_t Ready(const PoolKey& key) const;
+        PoolMetrics GetMetrics() const;
+
+    private:
+        struct Entry
+        {
+            std::deque<Puzzle> ready;
+            // puzzles being generated
+            size_t pending = 0;
+            bool refilling = true;
+            // failure of background generation
+            std::exception_ptr error;
+        };
+
+        // Entry of key, created on first use. Called with mutex held.
+        Entry& GetEntry(const PoolKey& key);
+        // Most depleted key which needs a puzzle, end if none. Called with mutex held.
+        std::map<PoolKey, Entry>::iterator FindRefill();
+
+        // Throw std::invalid_argument if key can't be generated.
+        static void Validate(const PoolKey& key);
+        BatchOptions GetBatchOptions(const PoolKey& key) const;
+        void Worker();
+
+        const Dictionary::Data& m_data;
+        const Dictionary::PatternIndex* m_index;
+        LetterDistribution m_letters;
+        PoolOptions m_options;
+        uint64_t m_seed;
+        uint64_t m_next = 0;
+
+        mutable std::mutex m_mutex;
+        std::condition_variable m_refill;
+        std::map<PoolKey, Entry> m_entries;
+        PoolMetrics m_metrics;
+        bool m_stop = false;
+
+        std::vector<std::thread> m_threads;
+    };
+}
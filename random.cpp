@@ -0,0 +1,32 @@
+#include "random.h"
+#include <random>
+
+namespace Random
+{
+    // splitmix64 step, recommended way to expand seed to xoshiro state
+    uint64_t SplitMix(uint64_t& state)
+    {
+        uint64_t z = (state += 0x9e3779b97f4a7c15ull);
+        z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ull;
+        z = (z ^ (z >> 27)) * 0x94d049bb133111ebull;
+        return z ^ (z >> 31);
+    }
+
+    Generator::Generator(uint64_t seed)
+    {
+        for (auto& state : m_state)
+            state = SplitMix(seed);
+    }
+
+    uint64_t DeriveSeed(uint64_t seed, uint64_t index)
+    {
+        uint64_t state = seed ^ SplitMix(index);
+        return SplitMix(state);
+    }
+
+    uint64_t GetRandomSeed()
+    {
+        std::random_device device;
+        return ((uint64_t)device() << 32) ^ device();
+    }
+}
@@ -0,0 +1,73 @@
+#pragma once
+#include <cstdint>
+#include <array>
+#include <iterator>
+#include <utility>
+
+namespace Random
+{
+    // Small seedable generator (xoshiro256**), state is 32 bytes so it is cheap to have one per
+    // thread or per puzzle. Same seed gives same sequence on every platform, that is why range
+    // and shuffle are implemented here instead of using std distributions.
+    class Generator
+    {
+    public:
+        using result_type = uint64_t;
+
+        explicit Generator(uint64_t seed);
+
+        static constexpr result_type min() { return 0; }
+        static constexpr result_type max() { return UINT64_MAX; }
+
+        result_type operator()()
+        {
+            uint64_t result = Rotate(m_state[1] * 5, 7) * 9;
+            uint64_t t = m_state[1] << 17;
+
+            m_state[2] ^= m_state[0];
+            m_state[3] ^= m_state[1];
+            m_state[1] ^= m_state[2];
+            m_state[0] ^= m_state[3];
+            m_state[2] ^= t;
+            m_state[3] = Rotate(m_state[3], 45);
+
+            return result;
+        }
+
+        // Uniform value from [from, to].
+        size_t Range(size_t from, size_t to)
+        {
+            uint64_t count = (uint64_t)(to - from) + 1;
+            if (count == 0)
+                return (size_t)(*this)();
+
+            // reject values of last incomplete block, so result is unbiased
+            uint64_t threshold = (0 - count) % count;
+            for (;;)
+            {
+                uint64_t value = (*this)();
+                if (value >= threshold)
+                    return from + (size_t)(value % count);
+            }
+        }
+
+        template<class It>
+        void Shuffle(It first, It last)
+        {
+            auto count = (size_t)std::distance(first, last);
+            for (size_t i = count; i > 1; --i)
+                std::swap(first[i - 1], first[Range(0, i - 1)]);
+        }
+
+    private:
+        static uint64_t Rotate(uint64_t value, int shift) { return (value << shift) | (value >> (64 - shift)); }
+
+        std::array<uint64_t, 4> m_state;
+    };
+
+    // Seed derived from seed and index (e.g. puzzle number in batch), different indices give
+    // unrelated sequences.
+    uint64_t DeriveSeed(uint64_t seed, uint64_t index);
+    // Nondeterministic seed.
+    uint64_t GetRandomSeed();
+}
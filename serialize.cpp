@@ -0,0 +1,280 @@
+#include "serialize.h"
+#include <charconv>
+#include <algorithm>
+#include <optional>
+
+namespace WordSearch
+{
+    // Limits of Binary record read back, larger sizes mean corrupted input. Board of most cells
+    // (2048x2048, e.g. tiled one) takes about 40 MB with its mirror and occupancy mask.
+    static constexpr uint32_t MAX_RECORD_SIDE = 1 << 16;
+    static constexpr uint64_t MAX_RECORD_CELLS = 1 << 22;
+    // cells of record are read in blocks, so truncated input does not allocate all of them
+    static constexpr size_t RECORD_READ_BLOCK = 1 << 16;
+
+    void AppendUint32(std::string& buffer, uint32_t value)
+    {
+        for (size_t i = 0; i < 4; ++i)
+            buffer.push_back((char)((value >> (8 * i)) & 0xff));
+    }
+
+    void AppendNumber(std::string& buffer, size_t value)
+    {
+        char digits[24];
+        auto end = std::to_chars(digits, digits + sizeof(digits), value).ptr;
+        buffer.append(digits, end);
+    }
+
+    // Quoted JSON string of cells or word, empty cell is written as EMPTY_CELL. Bytes above 127
+    // are copied as they are in UTF-8 text decoded by alphabet, otherwise they are not valid
+    // UTF-8 and they are escaped as characters U+0080 - U+00FF.
+    void AppendJsonString(std::string& buffer, const uint8_t* text, size_t size, bool utf8)
+    {
+        static const char HEX[] = "0123456789abcdef";
+
+        buffer.push_back('"');
+        for (size_t i = 0; i < size; ++i)
+        {
+            auto character = text[i];
+
+            if (character == 0)
+            {
+                buffer.push_back(EMPTY_CELL);
+            }
+            else if (character == '"' || character == '\\')
+            {
+                buffer.push_back('\\');
+                buffer.push_back((char)character);
+            }
+            else if (character < 0x20 || (character > 0x7f && !utf8))
+            {
+                buffer.append("\\u00");
+                buffer.push_back(HEX[character >> 4]);
+                buffer.push_back(HEX[character & 0xf]);
+            }
+            else
+            {
+                buffer.push_back((char)character);
+            }
+        }
+        buffer.push_back('"');
+    }
+
+    // Row of grid with empty cells replaced.
+    void AppendRow(std::string& buffer, const Board& board, size_t row, const Dictionary::Alphabet* alphabet)
+    {
+        std::string_view cells((const char*)board.Data() + board.Index(row, 0), board.Cols());
+
+        if (alphabet)
+        {
+            buffer.append(alphabet->Decode(cells, EMPTY_CELL));
+            return;
+        }
+
+        size_t start = buffer.size();
+        buffer.append(cells);
+        std::replace(std::begin(buffer) + start, std::end(buffer), '\0', EMPTY_CELL);
+    }
+
+    void AppendWord(std::string& buffer, std::string_view word, const Dictionary::Alphabet* alphabet)
+    {
+        if (alphabet)
+            buffer.append(alphabet->Decode(word));
+        else
+            buffer.append(word);
+    }
+
+    void AppendBinary(std::string& buffer, const Board& board, const Words& words)
+    {
+        AppendUint32(buffer, (uint32_t)board.Rows());
+        AppendUint32(buffer, (uint32_t)board.Cols());
+        AppendUint32(buffer, (uint32_t)words.size());
+
+        buffer.append((const char*)board.Data(), board.CellCount());
+
+        for (const auto& word : words)
+        {
+            buffer.push_back((char)word.size());
+            buffer.append(word);
+        }
+    }
+
+    void AppendJson(std::string& buffer, const Board& board, const Words& words, const Dictionary::Alphabet* alphabet)
+    {
+        // decoded text is quoted from scratch
+        std::string decoded;
+
+        buffer.append("{\"rows\":");
+        AppendNumber(buffer, board.Rows());
+        buffer.append(",\"cols\":");
+        AppendNumber(buffer, board.Cols());
+
+        buffer.append(",\"grid\":[");
+        for (size_t r = 0; r < board.Rows(); ++r)
+        {
+            if (r != 0)
+                buffer.push_back(',');
+
+            if (alphabet)
+            {
+                decoded.clear();
+                AppendRow(decoded, board, r, alphabet);
+                AppendJsonString(buffer, (const uint8_t*)decoded.data(), decoded.size(), true);
+            }
+            else
+            {
+                AppendJsonString(buffer, board.Data() + board.Index(r, 0), board.Cols(), false);
+            }
+        }
+
+        buffer.append("],\"words\":[");
+        for (size_t i = 0; i < words.size(); ++i)
+        {
+            if (i != 0)
+                buffer.push_back(',');
+
+            decoded.clear();
+            AppendWord(decoded, words[i], alphabet);
+            AppendJsonString(buffer, (const uint8_t*)decoded.data(), decoded.size(), alphabet != nullptr);
+        }
+        buffer.append("]}\n");
+    }
+
+    void AppendText(std::string& buffer, const Board& board, const Words& words, const Dictionary::Alphabet* alphabet)
+    {
+        for (size_t r = 0; r < board.Rows(); ++r)
+        {
+            AppendRow(buffer, board, r, alphabet);
+            buffer.push_back('\n');
+        }
+
+        for (size_t i = 0; i < words.size(); ++i)
+        {
+            if (i != 0)
+                buffer.push_back(' ');
+
+            AppendWord(buffer, words[i], alphabet);
+        }
+        buffer.append("\n\n");
+    }
+
+    void AppendPuzzle(std::string& buffer, Format format, const Board& board, const Words& words, const Dictionary::Alphabet* alphabet)
+    {
+        switch (format)
+        {
+        case Format::Binary:
+            AppendBinary(buffer, board, words);
+            break;
+        case Format::JsonLines:
+            AppendJson(buffer, board, words, alphabet);
+            break;
+        case Format::Text:
+            AppendText(buffer, board, words, alphabet);
+            break;
+        }
+    }
+
+    PuzzleWriter::PuzzleWriter(std::ostream& output, Format format, size_t blockSize, const Dictionary::Alphabet* alphabet)
+        : m_output(output), m_format(format), m_blockSize(blockSize), m_alphabet(alphabet)
+    {
+        m_buffer.reserve(blockSize);
+    }
+
+    PuzzleWriter::~PuzzleWriter()
+    {
+        Flush();
+    }
+
+    void PuzzleWriter::Write(const Board& board, const Words& words)
+    {
+        AppendPuzzle(m_buffer, m_format, board, words, m_alphabet);
+        m_count++;
+
+        if (m_buffer.size() >= m_blockSize)
+            Flush();
+    }
+
+    void PuzzleWriter::Flush()
+    {
+        if (m_buffer.empty())
+            return;
+
+        m_output.write(m_buffer.data(), (std::streamsize)m_buffer.size());
+        m_buffer.clear();
+    }
+
+    bool ReadUint32(std::istream& input, uint32_t& value)
+    {
+        uint8_t bytes[4];
+        if (!input.read((char*)bytes, sizeof(bytes)))
+            return false;
+
+        value = (uint32_t)bytes[0] | (uint32_t)bytes[1] << 8 | (uint32_t)bytes[2] << 16 | (uint32_t)bytes[3] << 24;
+        return true;
+    }
+
+    // Bytes left in input, nullopt if input is not seekable (e.g. pipe).
+    std::optional<uint64_t> GetRemainingSize(std::istream& input)
+    {
+        auto position = input.tellg();
+        if (position < 0 || !input.seekg(0, std::ios::end))
+        {
+            input.clear();
+            return std::nullopt;
+        }
+
+        auto end = input.tellg();
+        input.seekg(position);
+
+        return end < position ? 0 : (uint64_t)(end - position);
+    }
+
+    bool ReadBinaryPuzzle(std::istream& input, Board& board, std::vector<std::string>& words)
+    {
+        uint32_t rows, cols, wordCount;
+        if (!ReadUint32(input, rows) || !ReadUint32(input, cols) || !ReadUint32(input, wordCount))
+            return false;
+
+        // each word takes at least its size byte
+        uint64_t cellCount = (uint64_t)rows * cols;
+        if (rows > MAX_RECORD_SIDE || cols > MAX_RECORD_SIDE || cellCount > MAX_RECORD_CELLS || wordCount > MAX_RECORD_CELLS)
+            return false;
+
+        auto remaining = GetRemainingSize(input);
+        if (remaining && cellCount + wordCount > *remaining)
+            return false;
+
+        // board is built only once all cells were read
+        std::string cells;
+        while (cells.size() < cellCount)
+        {
+            size_t start = cells.size();
+            cells.resize(start + std::min<size_t>(RECORD_READ_BLOCK, (size_t)cellCount - start));
+            if (!input.read(cells.data() + start, (std::streamsize)(cells.size() - start)))
+                return false;
+        }
+
+        board = Board(rows, cols);
+        for (size_t i = 0; i < cells.size(); ++i)
+        {
+            if (cells[i] != 0)
+                board.Set(i, (uint8_t)cells[i]);
+        }
+
+        words.clear();
+        for (size_t i = 0; i < wordCount; ++i)
+        {
+            char size;
+            if (!input.get(size))
+                return false;
+
+            std::string word((uint8_t)size, '\0');
+            if (!input.read(word.data(), (std::streamsize)word.size()))
+                return false;
+
+            words.push_back(std::move(word));
+        }
+
+        return true;
+    }
+}
@@ -0,0 +1,61 @@
+#pragma once
+#include <ostream>
+#include <istream>
+#include <string>
+#include <vector>
+#include "wordSearch.h"
+#include "alphabet.h"
+
+namespace WordSearch
+{
+    enum class Format
+    {
+        // record: rows, cols and word count (uint32 little endian), rows * cols cells (0 is empty),
+        // then each word as its size (uint8) and letters
+        Binary,
+        // one JSON object per line: {"rows":2,"cols":2,"grid":["ab","c."],"words":["ab"]}, bytes
+        // above 127 not decoded by alphabet are escaped (\u0080 - \u00ff)
+        JsonLines,
+        // rows of grid, words on one line separated by spaces and empty line after each puzzle
+        Text
+    };
+
+    // Empty cell in JsonLines and Text grids.
+    static constexpr char EMPTY_CELL = '.';
+
+    // Append one puzzle to buffer, buffer is not cleared so it can collect many puzzles. Letters of
+    // board and words encoded by alphabet are decoded in JsonLines and Text, Binary keeps codes.
+    void AppendPuzzle(std::string& buffer, Format format, const Board& board, const Words& words, const Dictionary::Alphabet* alphabet = nullptr);
+
+    // Stream of puzzles written to output in large blocks. Puzzles are formatted into one reusable
+    // buffer, which is written when it exceeds block size, on Flush and on destruction.
+    class PuzzleWriter
+    {
+    public:
+        static constexpr size_t DEFAULT_BLOCK_SIZE = 1 << 20;
+
+        PuzzleWriter(std::ostream& output, Format format, size_t blockSize = DEFAULT_BLOCK_SIZE, const Dictionary::Alphabet* alphabet = nullptr);
+        ~PuzzleWriter();
+
+        PuzzleWriter(const PuzzleWriter&) = delete;
+        PuzzleWriter& operator=(const PuzzleWriter&) = delete;
+
+        void Write(const Board& board, const Words& words);
+        void Flush();
+
+        size_t Count() const { return m_count; }
+
+    private:
+        std::ostream& m_output;
+        Format m_format;
+        size_t m_blockSize;
+        const Dictionary::Alphabet* m_alphabet;
+        std::string m_buffer;
+        size_t m_count = 0;
+    };
+
+    // Read next Binary record, return false at the end of input, on truncated record or on sizes
+    // exceeding limits or remaining input. Words are returned as strings, because record does not
+    // refer to any dictionary.
+    bool ReadBinaryPuzzle(std::istream& input, Board& board, std::vector<std::string>& words);
+}
@@ -0,0 +1,428 @@
+#include "service.h"
+#include "serialize.h"
+#include "candidates.h"
+#include <charconv>
+#include <fstream>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include <algorithm>
+
+#ifndef _WIN32
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#include <cerrno>
+#include <cstring>
+#endif
+
+namespace WordSearch
+{
+    template<class T>
+    bool ParseNumber(std::string_view text, T& value)
+    {
+        auto [end, error] = std::from_chars(text.data(), text.data() + text.size(), value);
+
+        return error == std::errc() && end == text.data() + text.size();
+    }
+
+    // Call function(token) for each token of line separated by spaces, tabs or '\r'.
+    template<class T>
+    void ForEachToken(std::string_view line, T function)
+    {
+        static constexpr std::string_view SEPARATORS = " \t\r";
+
+        for (size_t start = line.find_first_not_of(SEPARATORS); start != std::string_view::npos; start = line.find_first_not_of(SEPARATORS, start))
+        {
+            size_t end = std::min(line.find_first_of(SEPARATORS, start), line.size());
+            function(line.substr(start, end - start));
+            start = end;
+        }
+    }
+
+    std::optional<ServiceRequest> ParseServiceRequest(std::string_view line)
+    {
+        ServiceRequest result;
+        bool valid = true;
+
+        ForEachToken(line, [&](std::string_view token)
+            {
+                size_t separator = token.find('=');
+                auto key = token.substr(0, separator);
+                auto value = separator != std::string_view::npos ? token.substr(separator + 1) : std::string_view();
+                uint64_t number = 0;
+
+                if (separator == std::string_view::npos || value.empty())
+                    valid = false;
+                else if (key == "id")
+                    result.id = value;
+                else if (key == "dict")
+                    result.dictionary = value;
+                else if (key == "placement")
+                {
+                    if (value == "random")
+                        result.placement = Placement::Random;
+                    else if (value == "overlap")
+                        result.placement = Placement::Overlap;
+                    else if (value == "slot")
+                        result.placement = Placement::Slot;
+                    else
+                        valid = false;
+                }
+                else if (!ParseNumber(value, number))
+                    valid = false;
+                else if (key == "rows")
+                    result.rows = (size_t)number;
+                else if (key == "cols")
+                    result.cols = (size_t)number;
+                else if (key == "from")
+                    result.wordSizeFrom = (size_t)number;
+                else if (key == "to")
+                    result.wordSizeTo = (size_t)number;
+                else if (key == "seed")
+                    result.seed = number;
+                else if (key == "fill" && number <= 1)
+                    result.fill = number == 1;
+                else
+                    valid = false;
+            });
+
+        valid = valid && result.rows != 0 && result.rows <= MAX_SERVICE_BOARD_SIZE && result.cols != 0 && result.cols <= MAX_SERVICE_BOARD_SIZE;
+        valid = valid && result.wordSizeFrom != 0 && result.wordSizeFrom <= result.wordSizeTo && result.wordSizeTo <= Dictionary::MAX_WORD_SIZE;
+
+        if (!valid)
+            return std::nullopt;
+
+        return result;
+    }
+
+    bool Service::AddDictionary(const std::string& name, const std::string& path)
+    {
+        auto entry = std::make_unique<Entry>();
+
+        if (entry->mapped.Open(path))
+        {
+            entry->data = &entry->mapped.GetData();
+            if (entry->mapped.GetAlphabet())
+                entry->alphabet = &*entry->mapped.GetAlphabet();
+        }
+        else
+        {
+            // text dictionary, ReadDictionary can't tell missing file from empty one
+            if (!std::ifstream(path))
+                return false;
+
+            entry->owned = Dictionary::ReadDictionary(path, entry->ownedAlphabet);
+            entry->data = &entry->owned;
+            entry->alphabet = &entry->ownedAlphabet;
+        }
+
+        entry->index = std::make_unique<Dictionary::PatternIndex>(*entry->data);
+        entry->letters = entry->mapped.GetLetterCounts() ? GetLetterDistribution(*entry->mapped.GetLetterCounts()) : GetLetterDistribution(*entry->data);
+
+        if (m_dictionaries.empty())
+            m_default = name;
+
+        m_dictionaries[name] = std::move(entry);
+        return true;
+    }
+
+    void Service::Warm(size_t rows, size_t cols) const
+    {
+        GetCandidateTable(rows, cols);
+    }
+
+    const Service::Entry* Service::Find(const std::string& name) const
+    {
+        auto entry = m_dictionaries.find(name.empty() ? m_default : name);
+
+        return entry != std::end(m_dictionaries) ? entry->second.get() : nullptr;
+    }
+
+    std::string Service::Handle(std::string_view line) const
+    {
+        auto request = ParseServiceRequest(line);
+        if (!request)
+        {
+            // echo id even of invalid request, so client can match the error
+            std::string id = "-";
+            ForEachToken(line, [&](std::string_view token)
+                {
+                    if (token.size() > 3 && token.substr(0, 3) == "id=")
+                        id = token.substr(3);
+                });
+
+            return id + " error invalid request\n";
+        }
+
+        auto entry = Find(request->dictionary);
+        if (!entry)
+            return request->id + " error unknown dictionary\n";
+
+        // exception must not leave worker thread, it would terminate whole service
+        try
+        {
+            uint64_t seed = request->seed ? *request->seed : Random::GetRandomSeed();
+            Random::Generator generator(seed);
+
+            PlacementPolicy policy;
+            policy.placement = request->placement;
+            policy.index = entry->index.get();
+
+            auto [board, words] = PositionWords(generator, *entry->data, request->rows, request->cols, request->wordSizeFrom, request->wordSizeTo, policy);
+
+            if (request->fill)
+                FillFreeCellsRandom(generator, board, words, entry->letters);
+
+            std::string result = request->id + " ok " + std::to_string(seed) + " ";
+            AppendPuzzle(result, Format::JsonLines, board, words, entry->alphabet);
+
+            return result;
+        }
+        catch (...)
+        {
+            return request->id + " error internal\n";
+        }
+    }
+
+    // Pipeline of Serve over any line source and sink. readLine returns false at the end of
+    // input, write returns false when output is closed.
+    void ServeLines(const Service& service, const std::function<bool(std::string&)>& readLine, const std::function<bool(const std::string&)>& write, size_t threadCount)
+    {
+        threadCount = threadCount != 0 ? threadCount : std::max(1u, std::thread::hardware_concurrency());
+        // bound memory of responses waiting for a slow request before them
+        size_t maxInFlight = 4 * threadCount;
+
+        std::mutex mutex;
+        std::condition_variable requestReady, responseReady, slotFree;
+        std::deque<std::pair<size_t, std::string>> requests;
+        std::map<size_t, std::string> responses;
+        size_t readCount = 0, writtenCount = 0;
+        bool inputEnd = false;
+
+        auto worker = [&]()
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            for (;;)
+            {
+                requestReady.wait(lock, [&]() { return !requests.empty() || inputEnd; });
+                if (requests.empty())
+                    break;
+
+                auto [index, line] = std::move(requests.front());
+                requests.pop_front();
+
+                lock.unlock();
+                auto response = service.Handle(line);
+                lock.lock();
+
+                responses[index] = std::move(response);
+                if (index == writtenCount)
+                    responseReady.notify_one();
+            }
+        };
+
+        auto writer = [&]()
+        {
+            std::string block;
+            bool open = true;
+
+            std::unique_lock<std::mutex> lock(mutex);
+            for (;;)
+            {
+                responseReady.wait(lock, [&]() { return responses.count(writtenCount) != 0 || (inputEnd && writtenCount == readCount); });
+                if (responses.count(writtenCount) == 0)
+                    break;
+
+                // all consecutive ready responses go out in one write
+                block.clear();
+                for (auto response = responses.find(writtenCount); response != std::end(responses) && response->first == writtenCount; response = responses.erase(response))
+                {
+                    block += response->second;
+                    ++writtenCount;
+                }
+                slotFree.notify_one();
+
+                lock.unlock();
+                open = open && write(block);
+                lock.lock();
+            }
+        };
+
+        std::vector<std::thread> threads;
+        for (size_t i = 0; i < threadCount; ++i)
+            threads.emplace_back(worker);
+        threads.emplace_back(writer);
+
+        std::string line;
+        while (readLine(line))
+        {
+            if (line.find_first_not_of(" \t\r") == std::string::npos)
+                continue;
+
+            std::unique_lock<std::mutex> lock(mutex);
+            slotFree.wait(lock, [&]() { return readCount - writtenCount < maxInFlight; });
+
+            requests.emplace_back(readCount++, std::move(line));
+            requestReady.notify_one();
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            inputEnd = true;
+        }
+        requestReady.notify_all();
+        responseReady.notify_all();
+
+        for (auto& thread : threads)
+            thread.join();
+    }
+
+    void Service::Serve(std::istream& input, std::ostream& output, size_t threadCount) const
+    {
+        ServeLines(*this,
+            [&](std::string& line) { return (bool)std::getline(input, line); },
+            [&](const std::string& block)
+            {
+                output.write(block.data(), (std::streamsize)block.size());
+                output.flush();
+                return (bool)output;
+            },
+            threadCount);
+    }
+
+#ifdef _WIN32
+    bool Service::ServeSocket(const std::string& path, size_t threadCount, size_t maxConnections) const
+    {
+        return false;
+    }
+#else
+    bool Service::ServeSocket(const std::string& path, size_t threadCount, size_t maxConnections) const
+    {
+        sockaddr_un address{};
+        address.sun_family = AF_UNIX;
+        if (path.size() >= sizeof(address.sun_path))
+            return false;
+
+        std::memcpy(address.sun_path, path.c_str(), path.size() + 1);
+
+        int server = socket(AF_UNIX, SOCK_STREAM, 0);
+        if (server < 0)
+            return false;
+
+        // socket file of previous run
+        unlink(path.c_str());
+
+        if (bind(server, (const sockaddr*)&address, sizeof(address)) != 0 || listen(server, SOMAXCONN) != 0)
+        {
+            close(server);
+            return false;
+        }
+
+        // number of connections being served, shared with their threads which may outlive this call
+        struct Connections
+        {
+            std::mutex mutex;
+            std::condition_variable done;
+            size_t count = 0;
+        };
+        auto connections = std::make_shared<Connections>();
+        maxConnections = std::max<size_t>(maxConnections, 1);
+
+        for (;;)
+        {
+            {
+                std::unique_lock<std::mutex> lock(connections->mutex);
+                connections->done.wait(lock, [&]() { return connections->count < maxConnections; });
+            }
+
+            int client = accept(server, nullptr, nullptr);
+            if (client < 0)
+            {
+                if (errno == EINTR || errno == ECONNABORTED)
+                    continue;
+
+                break;
+            }
+
+            {
+                std::lock_guard<std::mutex> lock(connections->mutex);
+                connections->count++;
+            }
+
+            std::thread([this, client, threadCount, connections]()
+                {
+                    std::string buffer;
+                    size_t start = 0;
+                    char chunk[4096];
+
+                    auto readLine = [&](std::string& line)
+                    {
+                        for (;;)
+                        {
+                            size_t end = buffer.find('\n', start);
+                            if (end != std::string::npos)
+                            {
+                                line.assign(buffer, start, end - start);
+                                start = end + 1;
+                                return true;
+                            }
+
+                            buffer.erase(0, start);
+                            start = 0;
+
+                            auto size = recv(client, chunk, sizeof(chunk), 0);
+                            if (size < 0 && errno == EINTR)
+                                continue;
+
+                            if (size <= 0)
+                            {
+                                // last line without newline
+                                line = std::move(buffer);
+                                buffer.clear();
+                                return !line.empty();
+                            }
+
+                            buffer.append(chunk, (size_t)size);
+                        }
+                    };
+
+                    auto write = [&](const std::string& block)
+                    {
+#ifdef MSG_NOSIGNAL
+                        int flags = MSG_NOSIGNAL;
+#else
+                        int flags = 0;
+#endif
+                        for (size_t written = 0; written < block.size();)
+                        {
+                            auto size = send(client, block.data() + written, block.size() - written, flags);
+                            if (size < 0 && errno == EINTR)
+                                continue;
+
+                            if (size <= 0)
+                                return false;
+
+                            written += (size_t)size;
+                        }
+
+                        return true;
+                    };
+
+                    ServeLines(*this, readLine, write, threadCount);
+                    close(client);
+
+                    std::lock_guard<std::mutex> lock(connections->mutex);
+                    connections->count--;
+                    connections->done.notify_one();
+                }).detach();
+        }
+
+        close(server);
+        return false;
+    }
+#endif
+}
@@ -0,0 +1,88 @@
+#pragma once
+#include <map>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <optional>
+#include <istream>
+#include <ostream>
+#include "wordSearch.h"
+#include "dictionaryFile.h"
+
+namespace WordSearch
+{
+    // Largest board accepted by service, larger boards are generated by PositionWordsTiled.
+    static constexpr size_t MAX_SERVICE_BOARD_SIZE = 64;
+    // Connections served at once by ServeSocket, further ones wait in listen queue.
+    static constexpr size_t MAX_SERVICE_CONNECTIONS = 16;
+
+    // One line of request: key=value tokens separated by spaces, all optional, e.g.
+    //   id=7 dict=cz rows=12 cols=12 from=4 to=8 seed=42 fill=1 placement=slot
+    struct ServiceRequest
+    {
+        // echoed in response, "-" if not set
+        std::string id = "-";
+        // name of dictionary, first loaded one if not set
+        std::string dictionary;
+        size_t rows = 10;
+        size_t cols = 10;
+        size_t wordSizeFrom = Dictionary::MIN_WORD_SIZE;
+        size_t wordSizeTo = Dictionary::MAX_WORD_SIZE;
+        // random if not set
+        std::optional<uint64_t> seed;
+        bool fill = true;
+        Placement placement = Placement::Random;
+    };
+
+    // Return nullopt for unknown key or invalid value.
+    std::optional<ServiceRequest> ParseServiceRequest(std::string_view line);
+
+    // Generator which keeps dictionaries loaded between requests, so request costs only its
+    // puzzle. Every request line gets exactly one response line:
+    //   <id> ok <seed> <puzzle in Format::JsonLines>
+    //   <id> error <reason>
+    // Failure of generation itself (e.g. out of memory) is answered by "error internal".
+    // Same request with the same seed always gets the same puzzle.
+    class Service
+    {
+    public:
+        // Load compiled dictionary (see MappedDictionary) or UTF-8 text word list under name, return
+        // false if file can't be read. Text words are encoded by their Alphabet, compiled ones use
+        // stored alphabet if any, responses are decoded by it. Pattern index for Slot placement is
+        // built here too.
+        bool AddDictionary(const std::string& name, const std::string& path);
+        // Generate candidate table of board size before first request needs it.
+        void Warm(size_t rows, size_t cols) const;
+
+        std::string Handle(std::string_view line) const;
+
+        // Answer request lines of input until it ends. Requests are handled on a pool of
+        // threads (0 means number of hardware threads) while next ones are read, responses are
+        // written in order of requests and flushed whenever no further one is ready.
+        void Serve(std::istream& input, std::ostream& output, size_t threadCount = 0) const;
+        // Accept connections on local (Unix domain) socket and serve each one as above, at most
+        // maxConnections at once, each on its own pool of threadCount threads. Return false if
+        // socket can't be created, otherwise it does not return.
+        bool ServeSocket(const std::string& path, size_t threadCount = 0, size_t maxConnections = MAX_SERVICE_CONNECTIONS) const;
+
+    private:
+        struct Entry
+        {
+            Dictionary::MappedDictionary mapped;
+            Dictionary::Data owned;
+            const Dictionary::Data* data = nullptr;
+            Dictionary::Alphabet ownedAlphabet;
+            // decodes words and boards, not set for compiled dictionary without alphabet
+            const Dictionary::Alphabet* alphabet = nullptr;
+            std::unique_ptr<Dictionary::PatternIndex> index;
+            // letters of free cells
+            LetterDistribution letters;
+        };
+
+        const Entry* Find(const std::string& name) const;
+
+        // entries do not move, index and words refer to their data
+        std::map<std::string, std::unique_ptr<Entry>> m_dictionaries;
+        std::string m_default;
+    };
+}
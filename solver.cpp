@@ -0,0 +1,297 @@
+#include "wordSearch.h"
+#include "candidates.h"
+#include "duplicates.h"
+#include "automaton.h"
+#include <algorithm>
+#include <bitset>
+
+namespace WordSearch
+{
+    using ApplyIndices = std::vector<size_t>;
+
+    ApplyIndices ApplyWordIndices(Board& board, const Candidate& position, std::string_view word);
+    void UnapplyWordIndices(Board& board, const Candidate& position, std::string_view word, const ApplyIndices& indices);
+
+    // Exact placement of fixed word list. Each word has a bitset domain of candidates it can still
+    // take (candidates of its size in all directions), the word with the smallest domain is placed
+    // first and after each placement domains of remaining words are pruned (forward checking).
+    class FixedWordsSolver
+    {
+    public:
+        FixedWordsSolver(Random::Generator& generator, size_t rows, size_t cols, const Words& words, const SolverLimits& limits);
+
+        std::optional<Board> Solve();
+
+    private:
+        using Domain = std::vector<uint64_t>;
+
+        bool Search(size_t placedCount);
+        size_t SelectWord() const;
+        bool Prune(const Candidate& position, size_t size, const ApplyIndices& applied);
+        bool LimitReached();
+
+        const Candidate& GetCandidate(size_t size, size_t index) const;
+        size_t GetIndex(Direction dir, size_t size, size_t line, size_t position) const { return m_dirStarts[size][(size_t)dir] + m_table->lineStarts[(size_t)dir][size][line] + position; }
+        size_t GetLineCount(Direction dir, size_t size, size_t line) const { return m_table->lineStarts[(size_t)dir][size][line + 1] - m_table->lineStarts[(size_t)dir][size][line]; }
+
+        static void Clear(Domain& domain, size_t index) { domain[index / 64] &= ~(1ull << (index % 64)); }
+        static bool Test(const Domain& domain, size_t index) { return (domain[index / 64] & (1ull << (index % 64))) != 0; }
+        static size_t Count(const Domain& domain);
+
+        Random::Generator& m_generator;
+        Board m_board;
+        const Words& m_words;
+        SolverLimits m_limits;
+
+        std::shared_ptr<const CandidateTable> m_table;
+        // candidates of one size are numbered direction after direction
+        std::array<std::array<size_t, (size_t)Direction::COUNT + 1>, Dictionary::MAX_WORD_SIZE> m_dirStarts{};
+
+        DuplicateDetector m_duplicates;
+
+        std::vector<Domain> m_domains;
+        std::vector<uint8_t> m_placed;
+        // domains saved before pruning, one set per search depth
+        std::vector<std::vector<Domain>> m_saved;
+
+        size_t m_nodes = 0;
+        std::chrono::steady_clock::time_point m_deadline;
+        bool m_aborted = false;
+    };
+
+    FixedWordsSolver::FixedWordsSolver(Random::Generator& generator, size_t rows, size_t cols, const Words& words, const SolverLimits& limits)
+        : m_generator(generator), m_board(rows, cols), m_words(words), m_limits(limits), m_table(GetCandidateTable(rows, cols)), m_duplicates(m_board, words)
+    {
+        for (size_t size = 0; size < Dictionary::MAX_WORD_SIZE; ++size)
+        {
+            for (size_t dir = 0; dir < (size_t)Direction::COUNT; ++dir)
+                m_dirStarts[size][dir + 1] = m_dirStarts[size][dir] + m_table->candidates[dir][size].size();
+        }
+
+        for (const auto& word : words)
+        {
+            size_t count = word.size() < Dictionary::MAX_WORD_SIZE ? m_dirStarts[word.size()][(size_t)Direction::COUNT] : 0;
+
+            Domain domain((count + 63) / 64, ~0ull);
+            if (count % 64)
+                domain.back() = (1ull << (count % 64)) - 1;
+
+            m_domains.push_back(std::move(domain));
+        }
+
+        m_placed.assign(words.size(), 0);
+        m_saved.resize(words.size());
+
+        if (m_limits.maxTime.count() != 0)
+            m_deadline = std::chrono::steady_clock::now() + m_limits.maxTime;
+    }
+
+    std::optional<Board> FixedWordsSolver::Solve()
+    {
+        // Word which contains other word (or itself twice, palindrome) can't be placed without duplication.
+        WordAutomaton automaton(m_words);
+
+        for (size_t i = 0; i < m_words.size(); ++i)
+        {
+            size_t selfCount = 0;
+            bool other = false;
+
+            automaton.Scan((const uint8_t*)m_words[i].data(), { 0, 1, m_words[i].size() }, [&](uint32_t word, size_t)
+                {
+                    selfCount += word == i ? 1 : 0;
+                    other = other || word != i;
+                });
+
+            if (other || selfCount > 1 || m_domains[i].empty())
+                return std::nullopt;
+        }
+
+        if (Search(0))
+            return m_board;
+
+        return std::nullopt;
+    }
+
+    size_t FixedWordsSolver::Count(const Domain& domain)
+    {
+        size_t result = 0;
+        for (auto bits : domain)
+            result += std::bitset<64>(bits).count();
+
+        return result;
+    }
+
+    const Candidate& FixedWordsSolver::GetCandidate(size_t size, size_t index) const
+    {
+        size_t dir = 0;
+        while (index >= m_dirStarts[size][dir + 1])
+            dir++;
+
+        return m_table->candidates[dir][size][index - m_dirStarts[size][dir]];
+    }
+
+    bool FixedWordsSolver::LimitReached()
+    {
+        m_nodes++;
+
+        if (m_limits.maxNodes != 0 && m_nodes > m_limits.maxNodes)
+            m_aborted = true;
+
+        if (m_limits.maxTime.count() != 0 && m_nodes % 256 == 0 && std::chrono::steady_clock::now() > m_deadline)
+            m_aborted = true;
+
+        return m_aborted;
+    }
+
+    // Most constrained word first, longer word on tie.
+    size_t FixedWordsSolver::SelectWord() const
+    {
+        size_t result = m_words.size();
+        size_t resultCount = 0;
+
+        for (size_t i = 0; i < m_words.size(); ++i)
+        {
+            if (m_placed[i])
+                continue;
+
+            size_t count = Count(m_domains[i]);
+
+            if (result == m_words.size() || count < resultCount || (count == resultCount && m_words[i].size() > m_words[result].size()))
+            {
+                result = i;
+                resultCount = count;
+            }
+        }
+
+        return result;
+    }
+
+    // Remove candidates of unplaced words which conflict with letters written by word of size
+    // on position or which overlap it on the same line. Return false if any domain becomes empty.
+    bool FixedWordsSolver::Prune(const Candidate& position, size_t size, const ApplyIndices& applied)
+    {
+        size_t kind = GetLineKind(position.dir);
+        size_t line = m_board.GetCellLines(position.row, position.col)[kind];
+        size_t cellPosition = m_board.GetCellLinePositions(position.row, position.col)[kind];
+
+        // positions [first, last] of line covered by placed word
+        size_t first = IsForward(position.dir) ? cellPosition : cellPosition + 1 - size;
+        size_t last = first + size - 1;
+
+        for (size_t i = 0; i < m_words.size(); ++i)
+        {
+            if (m_placed[i])
+                continue;
+
+            const auto& word = m_words[i];
+            auto& domain = m_domains[i];
+
+            // overlapping on the same line
+            for (auto dir : { position.dir, GetOpositeDirection(position.dir) })
+            {
+                size_t count = GetLineCount(dir, word.size(), line);
+                if (count == 0)
+                    continue;
+
+                size_t from = first + 1 >= word.size() ? first + 1 - word.size() : 0;
+                for (size_t p = from; p <= std::min(last, count - 1); ++p)
+                    Clear(domain, GetIndex(dir, word.size(), line, p));
+            }
+
+            // letters of new cells
+            for (auto applyIndex : applied)
+            {
+                size_t cell = m_board.Index(position.row, position.col) + applyIndex * m_board.Stride(position.dir);
+                size_t row = cell / m_board.Cols(), col = cell % m_board.Cols();
+                auto letter = m_board.Data()[cell];
+
+                auto cellLines = m_board.GetCellLines(row, col);
+                auto cellPositions = m_board.GetCellLinePositions(row, col);
+
+                for (size_t dir = 0; dir < (size_t)Direction::COUNT; ++dir)
+                {
+                    size_t cellKind = GetLineKind((Direction)dir);
+                    size_t count = GetLineCount((Direction)dir, word.size(), cellLines[cellKind]);
+                    if (count == 0)
+                        continue;
+
+                    size_t at = cellPositions[cellKind];
+                    size_t from = at + 1 >= word.size() ? at + 1 - word.size() : 0;
+
+                    for (size_t p = from; p <= std::min(at, count - 1); ++p)
+                    {
+                        size_t letterIndex = IsForward((Direction)dir) ? at - p : p + word.size() - 1 - at;
+
+                        if ((uint8_t)word[letterIndex] != letter)
+                            Clear(domain, GetIndex((Direction)dir, word.size(), cellLines[cellKind], p));
+                    }
+                }
+            }
+
+            if (Count(domain) == 0)
+                return false;
+        }
+
+        return true;
+    }
+
+    bool FixedWordsSolver::Search(size_t placedCount)
+    {
+        if (placedCount == m_words.size())
+            return true;
+
+        size_t wordIndex = SelectWord();
+        const auto& word = m_words[wordIndex];
+
+        std::vector<uint32_t> order;
+        for (size_t i = 0; i < m_dirStarts[word.size()][(size_t)Direction::COUNT]; ++i)
+        {
+            if (Test(m_domains[wordIndex], i))
+                order.push_back((uint32_t)i);
+        }
+        m_generator.Shuffle(std::begin(order), std::end(order));
+
+        auto& saved = m_saved[placedCount];
+        WordPattern pattern(word);
+
+        for (auto index : order)
+        {
+            const auto& candidate = GetCandidate(word.size(), index);
+
+            auto match = MatchWord(m_board, candidate, pattern);
+            if (!match.fits || match.emptyCount == 0)
+                continue;
+
+            if (LimitReached())
+                return false;
+
+            auto applied = ApplyWordIndices(m_board, candidate, word);
+            m_duplicates.Update(m_board, candidate, word.size());
+
+            if (!m_duplicates.IsAnyWordDuplicated())
+            {
+                m_placed[wordIndex] = 1;
+                saved = m_domains;
+
+                if (Prune(candidate, word.size(), applied) && Search(placedCount + 1))
+                    return true;
+
+                m_domains.swap(saved);
+                m_placed[wordIndex] = 0;
+            }
+
+            UnapplyWordIndices(m_board, candidate, word, applied);
+            m_duplicates.Update(m_board, candidate, word.size());
+
+            if (m_aborted)
+                return false;
+        }
+
+        return false;
+    }
+
+    std::optional<Board> PositionWords(Random::Generator& generator, size_t boardRows, size_t boardCols, const Words& words, const SolverLimits& limits)
+    {
+        return FixedWordsSolver(generator, boardRows, boardCols, words, limits).Solve();
+    }
+}
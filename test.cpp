@@ -1,7 +1,26 @@
 #include "test.h"
 #include "wordSearch.h"
+#include "duplicates.h"
+#include "batch.h"
+#include "tiles.h"
+#include "serialize.h"
+#include "finder.h"
+#include "dictionaryFile.h"
+#include "alphabet.h"
+#include "service.h"
+#include "pool.h"
+#include "differential.h"
+#include "improve.h"
+#include "candidates.h"
+#include <cstdio>
+#include <fstream>
+#include <sstream>
 #include <optional>
-#include <cassert>
+#include <iostream>
+#include <cstdlib>
+#include <algorithm>
+#include <thread>
+#include <stdexcept>
 
 namespace WordSearch
 {
@@ -9,21 +28,27 @@ namespace WordSearch
     std::optional<int> GetDirectedLineDistance(const Candidate& candidate, int row, int col);
     bool IsInterceptingCandidate(const Candidate& candidate1, size_t size1, const Candidate& candidate2, size_t size2);
 
-    bool VerifyWord(const Board& board, const Candidate& position, const std::string& word);
-    void ApplyWord(Board& board, const Candidate& position, const std::string& word);
-    size_t CountEmptyCells(const Board& board, const Candidate& position, const std::string& word);
-    bool CheckWord(const Board& board, const Candidate& position, const std::string& word);
+    bool VerifyWord(const Board& board, const Candidate& position, std::string_view word);
+    void ApplyWord(Board& board, const Candidate& position, std::string_view word);
+    size_t CountEmptyCells(const Board& board, const Candidate& position, std::string_view word);
+    bool CheckWord(const Board& board, const Candidate& position, std::string_view word);
     bool IsAnyWordDuplicated(const Board& board, const Words& words, const Candidates& candidates);
+    bool VerifyDuplication(const Board& board, const Words& words, const Candidate& position, std::string_view newWord, const Candidates& candidates);
 
     Candidates GetCandidates(size_t rows, size_t cols);
 }
 
 namespace Test
 {
+    // Checked in release builds too, failed check stops the program.
     template<class T1, class T2>
     void ASSERT(T1 value, T2 excepted)
     {
-        assert(value == excepted);
+        if (!(value == excepted))
+        {
+            std::cerr << "Test failed\n";
+            std::abort();
+        }
     }
 
     void Execute()
@@ -148,7 +173,68 @@ namespace Test
 
         //
 
-        WordSearch::Board board(10, std::vector<uint8_t>(10, 0));
+        // mirror spans follow cells in every direction until the end of line
+        const int steps[][2] = { { -1, 0 }, { 1, 0 }, { 0, -1 }, { 0, 1 }, { -1, -1 }, { -1, 1 }, { 1, -1 }, { 1, 1 } };
+        WordSearch::Board mirrored(5, 7);
+        for (size_t i = 0; i < mirrored.CellCount(); ++i)
+            mirrored.Set(i, (uint8_t)(i % 3 == 0 ? 0 : 'a' + i % 26));
+
+        for (size_t r = 0; r < mirrored.Rows(); ++r)
+        {
+            for (size_t c = 0; c < mirrored.Cols(); ++c)
+            {
+                for (size_t dir = 0; dir < (size_t)WordSearch::Direction::COUNT; ++dir)
+                {
+                    auto span = mirrored.Span(r, c, (WordSearch::Direction)dir);
+                    ptrdiff_t index = (ptrdiff_t)mirrored.Index(r, c);
+                    int row = (int)r, col = (int)c;
+                    int rowStep = steps[dir][0], colStep = steps[dir][1];
+
+                    size_t empty = 0;
+                    for (size_t i = 0; row >= 0 && row < (int)mirrored.Rows() && col >= 0 && col < (int)mirrored.Cols(); ++i)
+                    {
+                        ASSERT(span[i], mirrored.Data()[index]);
+                        empty += span[i] == 0 ? 1 : 0;
+                        ASSERT(mirrored.CountEmpty(r, c, (WordSearch::Direction)dir, i + 1), empty);
+
+                        index += mirrored.Stride((WordSearch::Direction)dir);
+                        row += rowStep;
+                        col += colStep;
+                    }
+                }
+            }
+        }
+
+        // free cells are counted on every write, spans longer than one occupancy word
+        WordSearch::Board wide(2, 150);
+        ASSERT(wide.FreeCellCount(), 300u);
+        for (size_t c = 0; c < 150; c += 2)
+            wide.Set(1, c, 'a');
+        wide.Set(1, 4, 'b');
+        wide.Set(1, 6, 0);
+        ASSERT(wide.FreeCellCount(), 226u);
+        ASSERT(wide.CountEmpty(1, 0, WordSearch::Direction::Right, 150), 76u);
+        ASSERT(wide.CountEmpty(1, 149, WordSearch::Direction::Left, 140), 70u);
+        ASSERT(wide.CountEmpty(0, 3, WordSearch::Direction::Right, 130), 130u);
+
+        // boards without cells have no lines
+        WordSearch::Board noCells(0, 0), noRows(0, 5);
+        ASSERT(noCells.LineCount(), 0u);
+        ASSERT(noRows.LineCount(), 0u);
+        ASSERT(noRows.CellCount(), 0u);
+        ASSERT(noRows.FreeCellCount(), 0u);
+        ASSERT(noRows == WordSearch::Board(0, 5), true);
+
+        // words longer than one 16 byte block
+        WordSearch::Board longBoard(1, 20);
+        WordSearch::ApplyWord(longBoard, { 0, 1, WordSearch::Direction::Right }, "abcdefghijklmnopq");
+        ASSERT(WordSearch::CheckWord(longBoard, { 0, 1, WordSearch::Direction::Right }, "abcdefghijklmnopq"), true);
+        ASSERT(WordSearch::CheckWord(longBoard, { 0, 17, WordSearch::Direction::Left }, "qponmlkjihgfedcba"), true);
+        ASSERT(WordSearch::VerifyWord(longBoard, { 0, 1, WordSearch::Direction::Right }, "abcdefghijklmnopx"), false);
+        ASSERT(WordSearch::VerifyWord(longBoard, { 0, 1, WordSearch::Direction::Right }, "abcdefghijklmnopqrs"), true);
+        ASSERT(WordSearch::CountEmptyCells(longBoard, { 0, 19, WordSearch::Direction::Left }, "xxqponmlkjihgfedcbay"), 3);
+
+        WordSearch::Board board(10, 10);
         WordSearch::Candidates candidates = WordSearch::GetCandidates(10, 10);
 
         ASSERT(WordSearch::VerifyWord(board, { 3, 4, WordSearch::Direction::DownRight }, "test"), true);
@@ -172,5 +258,594 @@ namespace Test
 
         ASSERT(WordSearch::IsAnyWordDuplicated(board, { "test" }, candidates), true);
         ASSERT(WordSearch::IsAnyWordDuplicated(board, { "strom" }, candidates), false);
+
+        WordSearch::DuplicateDetector duplicates(board, { "test", "strom" });
+        ASSERT(duplicates.IsAnyWordDuplicated(), true);
+        ASSERT(duplicates.GetCount(0), 2);
+        ASSERT(duplicates.GetCount(1), 1);
+
+        duplicates = WordSearch::DuplicateDetector(board, { "strom" });
+        ASSERT(duplicates.IsAnyWordDuplicated(), false);
+        ASSERT(duplicates.SetPendingWord(board, "test"), false);
+        ASSERT(duplicates.SetPendingWord(board, "mor"), false);
+        ASSERT(duplicates.SetPendingWord(board, "xstrom"), true);
+        ASSERT(duplicates.VerifyPlacement(board, { 0, 0, WordSearch::Direction::Right }), false);
+        ASSERT(WordSearch::VerifyDuplication(board, { "strom" }, { 0, 0, WordSearch::Direction::Right }, "xstrom", candidates), false);
+        ASSERT(duplicates.SetPendingWord(board, "xstro"), true);
+        ASSERT(duplicates.VerifyPlacement(board, { 0, 0, WordSearch::Direction::Right }), true);
+        ASSERT(WordSearch::VerifyDuplication(board, { "strom" }, { 0, 0, WordSearch::Direction::Right }, "xstro", candidates), true);
+        ASSERT(duplicates.SetPendingWord(board, "aba"), true);
+        ASSERT(duplicates.VerifyPlacement(board, { 0, 0, WordSearch::Direction::Right }), false);
+
+        Random::Generator generator(1);
+
+        WordSearch::Board filled(board);
+        ASSERT(WordSearch::FillFreeCellsRandom(generator, filled, { "strom" }).empty(), true);
+        ASSERT(WordSearch::GetFreeCellsCount(filled), 0);
+        ASSERT(WordSearch::IsAnyWordDuplicated(filled, { "strom" }, candidates), false);
+
+        WordSearch::Board blocked(1, 3);
+        std::vector<std::string> blockingLetters;
+        for (char c = 'a'; c <= 'z'; ++c)
+            blockingLetters.push_back(std::string("ab") + c);
+        WordSearch::Words blockingWords(std::begin(blockingLetters), std::end(blockingLetters));
+        WordSearch::ApplyWord(blocked, { 0, 0, WordSearch::Direction::Right }, "ab");
+        ASSERT(WordSearch::FillFreeCellsRandom(generator, blocked, blockingWords) == std::vector<std::tuple<size_t, size_t>>{ { 0, 2 } }, true);
+
+        WordSearch::Words fixedWords{ "strom", "test", "kolo", "auto", "vlak", "les", "pole" };
+        auto fixedBoard = WordSearch::PositionWords(generator, 6, 6, fixedWords);
+        ASSERT(fixedBoard.has_value(), true);
+        ASSERT(WordSearch::IsAnyWordDuplicated(*fixedBoard, fixedWords, WordSearch::GetCandidates(6, 6)), false);
+        for (const auto& word : fixedWords)
+        {
+            auto wordCandidates = WordSearch::GetCandidates(6, 6)[word.size()];
+            ASSERT(std::any_of(std::begin(wordCandidates), std::end(wordCandidates), [&](const auto& c) { return WordSearch::CheckWord(*fixedBoard, c, word); }), true);
+        }
+
+        ASSERT(WordSearch::PositionWords(generator, 6, 6, { "test", "est" }).has_value(), false);
+        ASSERT(WordSearch::PositionWords(generator, 3, 3, { "test" }).has_value(), false);
+        ASSERT(std::get<1>(WordSearch::PositionWords(generator, Dictionary::Data(), 0, 5)).empty(), true);
+
+        Dictionary::Data batchData;
+        for (auto word : { "strom", "kolo", "auto", "vlak", "pole", "mesto", "voda", "okno", "ruka", "noha", "hora", "reka", "kniha", "stul", "dum" })
+            batchData[std::string_view(word).size()].Add(word);
+
+        // random word lists give up when dictionary has too few words instead of retrying forever
+        auto randomWords = Dictionary::GetRandomWords(generator, batchData, 11, 4, 4);
+        ASSERT(randomWords.has_value(), true);
+        std::sort(std::begin(*randomWords), std::end(*randomWords));
+        ASSERT(std::adjacent_find(std::begin(*randomWords), std::end(*randomWords)) == std::end(*randomWords), true);
+        ASSERT(Dictionary::GetRandomWords(generator, batchData, 12, 4, 4).has_value(), false);
+        ASSERT(Dictionary::GetRandomWords(generator, Dictionary::Data(), 1).has_value(), false);
+
+        WordSearch::BatchOptions batchOptions;
+        batchOptions.rows = 8;
+        batchOptions.cols = 8;
+        batchOptions.threadCount = 4;
+
+        auto puzzles = WordSearch::GeneratePuzzles(batchData, 20, batchOptions);
+        ASSERT(puzzles.size(), 20u);
+        for (const auto& puzzle : puzzles)
+        {
+            ASSERT(puzzle.words.empty(), false);
+            ASSERT(puzzle.board.Rows(), 8u);
+            ASSERT(WordSearch::IsAnyWordDuplicated(puzzle.board, puzzle.words, WordSearch::GetCandidates(8, 8)), false);
+        }
+
+        WordSearch::Stats stats;
+        auto [statsBoard, statsWords] = WordSearch::PositionWords(generator, batchData, 8, 8, Dictionary::MIN_WORD_SIZE, Dictionary::MAX_WORD_SIZE, {}, &stats);
+        size_t statsFreeCells = WordSearch::GetFreeCellsCount(statsBoard);
+        auto unfillable = WordSearch::FillFreeCellsRandom(generator, statsBoard, statsWords, &stats);
+
+        ASSERT(stats.placements, statsWords.size());
+        ASSERT(stats.attempts, stats.placements + stats.missingWords + stats.repeatedWords + stats.presentWords + stats.exhaustedCandidates);
+        ASSERT(stats.candidatesScanned >= stats.rejectedLetters + stats.rejectedNoEmptyCell + stats.rejectedDuplication + stats.placements, true);
+        ASSERT(stats.filledCells + stats.unfillableCells, statsFreeCells);
+        ASSERT(stats.unfillableCells, unfillable.size());
+
+        WordSearch::PlacementPolicy overlap{ WordSearch::Placement::Overlap, 2 };
+        for (size_t i = 0; i < 10; ++i)
+        {
+            auto [overlapBoard, overlapWords] = WordSearch::PositionWords(generator, batchData, 8, 8, Dictionary::MIN_WORD_SIZE, Dictionary::MAX_WORD_SIZE, overlap);
+            ASSERT(overlapWords.empty(), false);
+            ASSERT(WordSearch::IsAnyWordDuplicated(overlapBoard, overlapWords, WordSearch::GetCandidates(8, 8)), false);
+        }
+
+        // anytime generation: stops at targets or deadline, without limits it is the same as unlimited
+        WordSearch::GenerationLimits limits;
+        limits.targetWords = 3;
+        auto targeted = WordSearch::PositionWords(generator, batchData, 8, 8, Dictionary::MIN_WORD_SIZE, Dictionary::MAX_WORD_SIZE, limits);
+        ASSERT(targeted.words.size(), 3u);
+        ASSERT(targeted.targetReached, true);
+        ASSERT(targeted.timedOut, false);
+
+        Random::Generator unlimitedGenerator(21), anytimeGenerator(21);
+        auto [unlimitedBoard, unlimitedWords] = WordSearch::PositionWords(unlimitedGenerator, batchData, 8, 8);
+        limits = {};
+        limits.maxTime = std::chrono::milliseconds(10000);
+        auto anytime = WordSearch::PositionWords(anytimeGenerator, batchData, 8, 8, Dictionary::MIN_WORD_SIZE, Dictionary::MAX_WORD_SIZE, limits);
+        ASSERT(anytime.board, unlimitedBoard);
+        ASSERT(anytime.targetReached, true);
+
+        limits = {};
+        limits.targetDensity = 1;
+        auto dense = WordSearch::PositionWords(generator, batchData, 8, 8, Dictionary::MIN_WORD_SIZE, Dictionary::MAX_WORD_SIZE, limits);
+        ASSERT(dense.targetReached, false);
+        ASSERT(dense.timedOut, false);
+
+        limits.deadline = std::chrono::steady_clock::now();
+        auto late = WordSearch::PositionWords(generator, batchData, 8, 8, Dictionary::MIN_WORD_SIZE, Dictionary::MAX_WORD_SIZE, limits);
+        ASSERT(late.words.empty(), true);
+        ASSERT(late.timedOut, true);
+        ASSERT(late.targetReached, false);
+
+        Dictionary::PatternIndex patternIndex(batchData);
+        ASSERT(patternIndex.CountMatches((const uint8_t*)"\0o\0o", 4), 1u);
+        ASSERT(*patternIndex.GetRandomMatch(generator, (const uint8_t*)"\0o\0o", 4), "kolo");
+        ASSERT(patternIndex.CountMatches((const uint8_t*)"\0\0\0\0", 4), 11u);
+        ASSERT(patternIndex.CountMatches((const uint8_t*)"\0\0\0x", 4), 0u);
+        ASSERT(patternIndex.GetRandomMatch(generator, (const uint8_t*)"\0\0\0\0\0\0", 6).has_value(), false);
+
+        WordSearch::PlacementPolicy slot{ WordSearch::Placement::Slot, 0, &patternIndex };
+        for (size_t i = 0; i < 10; ++i)
+        {
+            auto [slotBoard, slotWords] = WordSearch::PositionWords(generator, batchData, 8, 8, Dictionary::MIN_WORD_SIZE, Dictionary::MAX_WORD_SIZE, slot);
+            ASSERT(slotWords.empty(), false);
+            ASSERT(WordSearch::IsAnyWordDuplicated(slotBoard, slotWords, WordSearch::GetCandidates(8, 8)), false);
+        }
+
+        // densification keeps puzzle valid and never loses covered cells, filled board is left as it is
+        Random::Generator improveGenerator(13);
+        for (size_t i = 0; i < 10; ++i)
+        {
+            auto [improvedBoard, improvedWords] = WordSearch::PositionWords(improveGenerator, batchData, 8, 8);
+            WordSearch::ImproveOptions improveOptions;
+            improveOptions.iterations = 50;
+
+            auto improved = WordSearch::ImproveBoard(improveGenerator, patternIndex, improvedBoard, improvedWords, improveOptions);
+            ASSERT(improved.coveredAfter >= improved.coveredBefore, true);
+            ASSERT(improved.coveredAfter, improvedBoard.CellCount() - improvedBoard.FreeCellCount());
+            ASSERT(WordSearch::WordFinder(improvedWords).IsValid(improvedBoard), true);
+
+            WordSearch::FillFreeCellsRandom(improveGenerator, improvedBoard, improvedWords);
+            auto filledBoard = improvedBoard;
+            auto unchanged = WordSearch::ImproveBoard(improveGenerator, patternIndex, improvedBoard, improvedWords, improveOptions);
+            ASSERT(unchanged.iterations, 0u);
+            ASSERT(improvedBoard, filledBoard);
+        }
+
+        // same seed gives same puzzle, regardless of thread count
+        batchOptions.seed = 42;
+        auto seeded = WordSearch::GeneratePuzzles(batchData, 8, batchOptions);
+        batchOptions.threadCount = 1;
+        auto seededAgain = WordSearch::GeneratePuzzles(batchData, 8, batchOptions);
+
+        for (size_t i = 0; i < seeded.size(); ++i)
+        {
+            ASSERT(seeded[i].board, seededAgain[i].board);
+            ASSERT(seeded[i].words, seededAgain[i].words);
+
+            Random::Generator puzzleGenerator(seeded[i].seed);
+            auto [board, words] = WordSearch::PositionWords(puzzleGenerator, batchData, 8, 8);
+            WordSearch::FillFreeCellsRandom(puzzleGenerator, board, words, WordSearch::GetLetterDistribution(batchData));
+            ASSERT(board, seeded[i].board);
+        }
+
+        // large board: tiles must keep words unique across seams, result must not depend on threads
+        Dictionary::Data tileData;
+        Random::Generator wordGenerator(11);
+        for (size_t i = 0; i < 3000; ++i)
+        {
+            std::string word;
+            for (size_t size = wordGenerator.Range(3, 8); word.size() < size;)
+                word.push_back((char)('a' + wordGenerator.Range(0, 25)));
+
+            tileData[word.size()].Add(word);
+        }
+
+        // more words than recent automaton of duplicate detector holds, all of them stay unique
+        Random::Generator largeGenerator(3);
+        auto [largeBoard, largeWords] = WordSearch::PositionWords(largeGenerator, tileData, 24, 24);
+        ASSERT(largeWords.size() > 64, true);
+        ASSERT(WordSearch::WordFinder(largeWords).IsValid(largeBoard), true);
+
+        // large board: setup fits the budget once table is warm, passed deadline skips it
+        WordSearch::GetCandidateTable(150, 150);
+        Random::Generator budgetGenerator(9);
+        auto largeStart = std::chrono::steady_clock::now();
+        WordSearch::GenerationLimits largeLimits;
+        largeLimits.maxTime = std::chrono::milliseconds(20);
+        auto budgeted = WordSearch::PositionWords(budgetGenerator, tileData, 150, 150, Dictionary::MIN_WORD_SIZE, Dictionary::MAX_WORD_SIZE, largeLimits);
+        ASSERT(budgeted.words.empty(), false);
+        ASSERT(budgeted.timedOut, true);
+        ASSERT(std::chrono::steady_clock::now() - largeStart < std::chrono::seconds(1), true);
+
+        largeStart = std::chrono::steady_clock::now();
+        largeLimits.deadline = largeStart;
+        auto skipped = WordSearch::PositionWords(budgetGenerator, tileData, 200, 190, Dictionary::MIN_WORD_SIZE, Dictionary::MAX_WORD_SIZE, largeLimits);
+        ASSERT(skipped.words.empty(), true);
+        ASSERT(skipped.timedOut, true);
+        ASSERT(std::chrono::steady_clock::now() - largeStart < std::chrono::milliseconds(50), true);
+
+        WordSearch::TileOptions tileOptions;
+        tileOptions.tileSize = 12;
+        tileOptions.threadCount = 3;
+
+        Random::Generator tileGenerator(5), tileGeneratorAgain(5);
+        WordSearch::Stats tileStats;
+        auto [tiledBoard, tiledWords] = WordSearch::PositionWordsTiled(tileGenerator, tileData, 40, 50, tileOptions, &tileStats);
+
+        ASSERT(tiledWords.empty(), false);
+        ASSERT(tileStats.placements, tiledWords.size() + tileStats.removedWords);
+        ASSERT(tiledBoard.FreeCellCount(), (size_t)std::count(tiledBoard.Data(), tiledBoard.Data() + tiledBoard.CellCount(), 0));
+        for (auto count : WordSearch::CountOccurrences(tiledBoard, tiledWords))
+            ASSERT(count, 1u);
+
+        // letters of removed words are cleared, every letter left belongs to a kept word
+        std::vector<bool> tiledCovered(tiledBoard.CellCount());
+        for (const auto& occurrence : WordSearch::FindOccurrences(tiledBoard, tiledWords))
+        {
+            auto index = (ptrdiff_t)tiledBoard.Index(occurrence.position.row, occurrence.position.col);
+            for (size_t i = 0; i < tiledWords[occurrence.word].size(); ++i, index += tiledBoard.Stride(occurrence.position.dir))
+                tiledCovered[(size_t)index] = true;
+        }
+        for (size_t i = 0; i < tiledBoard.CellCount(); ++i)
+            ASSERT(tiledCovered[i] || tiledBoard.Data()[i] == 0, true);
+
+        tileOptions.threadCount = 1;
+        auto [tiledBoardAgain, tiledWordsAgain] = WordSearch::PositionWordsTiled(tileGeneratorAgain, tileData, 40, 50, tileOptions);
+        ASSERT(tiledBoardAgain, tiledBoard);
+        ASSERT(tiledWordsAgain, tiledWords);
+
+        // only most recently used candidate tables stay cached
+        std::weak_ptr<const WordSearch::CandidateTable> oldestTable = WordSearch::GetCandidateTable(5, 40);
+        ASSERT(WordSearch::GetCandidateTable(5, 40) == oldestTable.lock(), true);
+        for (size_t cols = 41; cols <= 40 + WordSearch::MAX_CACHED_TABLES; ++cols)
+            WordSearch::GetCandidateTable(5, cols);
+        ASSERT(oldestTable.expired(), true);
+
+        // board holds more words than dictionary has, tiles stop once all of them are placed
+        Dictionary::Data fewData;
+        for (size_t i = 0; i < 30; ++i)
+        {
+            std::string word;
+            while (word.size() < 5)
+                word.push_back((char)('a' + wordGenerator.Range(0, 25)));
+
+            fewData[word.size()].Add(word);
+        }
+
+        auto fewOptions = tileOptions;
+        fewOptions.wordSizeFrom = 5;
+        fewOptions.wordSizeTo = 5;
+
+        Random::Generator fewGenerator(7);
+        auto [fewBoard, fewWords] = WordSearch::PositionWordsTiled(fewGenerator, fewData, 60, 60, fewOptions);
+        ASSERT(fewWords.empty(), false);
+        ASSERT(fewWords.size() <= 30, true);
+        for (auto count : WordSearch::CountOccurrences(fewBoard, fewWords))
+            ASSERT(count, 1u);
+
+        WordSearch::Board smallBoard(2, 3);
+        smallBoard.Set(0, 0, 'a');
+        smallBoard.Set(0, 1, 'b');
+        smallBoard.Set(1, 2, '"');
+        WordSearch::Words smallWords = { "ab", "x\\y" };
+
+        std::string json, text;
+        WordSearch::AppendPuzzle(json, WordSearch::Format::JsonLines, smallBoard, smallWords);
+        WordSearch::AppendPuzzle(text, WordSearch::Format::Text, smallBoard, smallWords);
+        ASSERT(json, std::string("{\"rows\":2,\"cols\":3,\"grid\":[\"ab.\",\"..\\\"\"],\"words\":[\"ab\",\"x\\\\y\"]}\n"));
+        ASSERT(text, std::string("ab.\n..\"\nab x\\y\n\n"));
+
+        // binary records stream through small blocks and read back unchanged
+        std::stringstream binary;
+        {
+            WordSearch::PuzzleWriter writer(binary, WordSearch::Format::Binary, 64);
+            for (const auto& puzzle : puzzles)
+                writer.Write(puzzle.board, puzzle.words);
+            writer.Write(tiledBoard, tiledWords);
+        }
+
+        WordSearch::Board readBoard;
+        std::vector<std::string> readWords;
+        for (const auto& puzzle : puzzles)
+        {
+            ASSERT(WordSearch::ReadBinaryPuzzle(binary, readBoard, readWords), true);
+            ASSERT(readBoard, puzzle.board);
+            ASSERT(WordSearch::Words(std::begin(readWords), std::end(readWords)), puzzle.words);
+        }
+        ASSERT(WordSearch::ReadBinaryPuzzle(binary, readBoard, readWords), true);
+        ASSERT(readBoard, tiledBoard);
+        ASSERT(readWords.size(), tiledWords.size());
+        ASSERT(WordSearch::ReadBinaryPuzzle(binary, readBoard, readWords), false);
+
+        // empty board round-trips, corrupted sizes are rejected without allocating them
+        std::stringstream emptyBinary;
+        {
+            WordSearch::PuzzleWriter writer(emptyBinary, WordSearch::Format::Binary);
+            writer.Write(WordSearch::Board(0, 0), {});
+            writer.Write(WordSearch::Board(0, 5), {});
+        }
+        ASSERT(WordSearch::ReadBinaryPuzzle(emptyBinary, readBoard, readWords), true);
+        ASSERT(readBoard, WordSearch::Board(0, 0));
+        ASSERT(readWords.empty(), true);
+        ASSERT(WordSearch::ReadBinaryPuzzle(emptyBinary, readBoard, readWords), true);
+        ASSERT(readBoard.Cols(), 5u);
+        ASSERT(WordSearch::ReadBinaryPuzzle(emptyBinary, readBoard, readWords), false);
+
+        std::stringstream hugeBinary(std::string("\xff\xff\x00\x00\xff\xff\x00\x00\x00\x00\x00\x00", 12));
+        ASSERT(WordSearch::ReadBinaryPuzzle(hugeBinary, readBoard, readWords), false);
+        std::stringstream manyWordsBinary(std::string("\x02\x00\x00\x00\x02\x00\x00\x00\xff\xff\xff\x00" "abcd", 16));
+        ASSERT(WordSearch::ReadBinaryPuzzle(manyWordsBinary, readBoard, readWords), false);
+        std::stringstream tooManyCellsBinary(std::string("\x00\x10\x00\x00\x00\x10\x00\x00\x00\x00\x00\x00", 12));
+        ASSERT(WordSearch::ReadBinaryPuzzle(tooManyCellsBinary, readBoard, readWords), false);
+
+        // truncated record from input which can't tell its size (e.g. pipe) is rejected too
+        struct PipeBuffer : std::streambuf
+        {
+            explicit PipeBuffer(std::string& data) { setg(data.data(), data.data(), data.data() + data.size()); }
+        };
+        std::string truncatedRecord("\x00\x08\x00\x00\x00\x08\x00\x00\x00\x00\x00\x00" "abcd", 16);
+        PipeBuffer truncatedBuffer(truncatedRecord);
+        std::istream truncatedBinary(&truncatedBuffer);
+        ASSERT(WordSearch::ReadBinaryPuzzle(truncatedBinary, readBoard, readWords), false);
+
+        // finder agrees with reference check and reports positions reading the words
+        for (const auto& puzzle : puzzles)
+        {
+            WordSearch::WordFinder finder(puzzle.words);
+            ASSERT(finder.IsValid(puzzle.board), !WordSearch::IsAnyWordDuplicated(puzzle.board, puzzle.words, WordSearch::GetCandidates(8, 8)));
+
+            auto occurrences = finder.Find(puzzle.board);
+            ASSERT(occurrences.size(), puzzle.words.size());
+            for (const auto& occurrence : occurrences)
+                ASSERT(WordSearch::MatchWord(puzzle.board, occurrence.position, WordSearch::WordPattern(puzzle.words[occurrence.word])).equal, true);
+        }
+
+        WordSearch::Board findBoard(3, 4);
+        for (auto [row, col, letter] : { std::tuple{ 2, 3, 'c' }, { 1, 2, 'a' }, { 0, 1, 't' }, { 0, 0, 'o' } })
+            findBoard.Set(row, col, (uint8_t)letter);
+
+        auto found = WordSearch::FindOccurrences(findBoard, { "cat", "to", "x" });
+        ASSERT(found.size(), 2u);
+        ASSERT(found[0].word, 1u);
+        ASSERT(found[0].position.row == 0 && found[0].position.col == 1 && found[0].position.dir == WordSearch::Direction::Left, true);
+        ASSERT(found[1].word, 0u);
+        ASSERT(found[1].position.row == 2 && found[1].position.col == 3 && found[1].position.dir == WordSearch::Direction::UpLeft, true);
+        ASSERT(WordSearch::CountOccurrences(findBoard, { "cat", "aca" }), std::vector<size_t>{ 1, 0 });
+
+        // compiled dictionary: sorted, deduplicated and usable through Data without parsing
+        Dictionary::Data compiledSource = batchData;
+        compiledSource[4].Add("kolo");
+        ASSERT(Dictionary::WriteCompiledDictionary(compiledSource, "test-dictionary.tmp"), true);
+        {
+            Dictionary::MappedDictionary mapped;
+            ASSERT(mapped.Open("test-dictionary.tmp"), true);
+
+            const auto& mappedData = mapped.GetData();
+            for (size_t size = 0; size < Dictionary::MAX_WORD_SIZE; ++size)
+            {
+                WordSearch::Words expected, actual;
+                for (size_t i = 0; i < batchData[size].Count(); ++i)
+                    expected.push_back(batchData[size][i]);
+                for (size_t i = 0; i < mappedData[size].Count(); ++i)
+                    actual.push_back(mappedData[size][i]);
+
+                std::sort(std::begin(expected), std::end(expected));
+                ASSERT(actual, expected);
+            }
+
+            ASSERT(mapped.GetLetterCounts().has_value(), true);
+            ASSERT(*mapped.GetLetterCounts(), Dictionary::CountLetters(batchData));
+            ASSERT(Dictionary::GetRandomWord(generator, mappedData, 5).has_value(), true);
+
+            auto [mappedBoard, mappedWords] = WordSearch::PositionWords(generator, mappedData, 8, 8);
+            ASSERT(mappedWords.empty(), false);
+        }
+
+        std::ofstream("test-dictionary.tmp", std::ios::binary) << "WSD1 truncated";
+        Dictionary::MappedDictionary corrupted;
+        ASSERT(corrupted.Open("test-dictionary.tmp"), false);
+        ASSERT(corrupted.Open("missing-dictionary.tmp"), false);
+        std::remove("test-dictionary.tmp");
+
+        // alphabet: multi-byte letters are one code each, decoding restores UTF-8
+        Dictionary::Alphabet alphabet;
+        ASSERT(alphabet.AddLetters("\xc4\x8d\xc3\xa1p"), true);
+        ASSERT(alphabet.Size(), 3u);
+        ASSERT(*alphabet.Encode("p\xc4\x8d"), std::string("\x03\x01"));
+        ASSERT(alphabet.Encode("px").has_value(), false);
+        ASSERT(alphabet.Decode(std::string("\x01\x02\x00\x03", 4)), std::string("\xc4\x8d\xc3\xa1.p"));
+        ASSERT(alphabet.AddLetters("\xc4"), false);
+        ASSERT(alphabet.Size(), 3u);
+        ASSERT(alphabet.Decode("\x04\x01"), std::string("?\xc4\x8d"));
+        ASSERT(alphabet.GetLetter(0).empty() && alphabet.GetLetter(4).empty(), true);
+
+        std::ofstream("test-alphabet.tmp") << "\xc4\x8d\xc3\xa1p\nkr\xc3\xa1l\n\xc5\xbe\xc3\xa1\x62\x61\nkos\nxyzwvutsrqponmlkjihgfedcba\n";
+        Dictionary::Alphabet readAlphabet;
+        auto encodedData = Dictionary::ReadDictionary("test-alphabet.tmp", readAlphabet);
+        std::remove("test-alphabet.tmp");
+        ASSERT(encodedData[3].Count(), 2u);
+        ASSERT(encodedData[4].Count(), 2u);
+        ASSERT(readAlphabet.Decode(encodedData[3][0]), std::string("\xc4\x8d\xc3\xa1p"));
+        // letters of too long word are not added
+        ASSERT(readAlphabet.Size(), 11u);
+
+        auto distribution = WordSearch::GetLetterDistribution(encodedData);
+        ASSERT(distribution.letters.size(), readAlphabet.Size());
+        ASSERT(distribution.weights[readAlphabet.Encode("\xc3\xa1")->front() - 1], 3u);
+
+        WordSearch::Words encodedWords = { encodedData[4][0], encodedData[3][1] };
+        WordSearch::Board encodedBoard(4, 4);
+        ApplyWord(encodedBoard, { 0, 0, WordSearch::Direction::Right }, encodedWords[0]);
+        ApplyWord(encodedBoard, { 3, 0, WordSearch::Direction::Right }, encodedWords[1]);
+        WordSearch::FillFreeCellsRandom(generator, encodedBoard, encodedWords, distribution);
+        for (size_t i = 0; i < encodedBoard.Rows() * encodedBoard.Cols(); ++i)
+            ASSERT(encodedBoard.Data()[i] <= readAlphabet.Size(), true);
+        ASSERT(WordSearch::WordFinder(encodedWords).IsValid(encodedBoard), true);
+
+        // batch fills encoded boards with letters of dictionary, not 'a' - 'z'
+        WordSearch::BatchOptions encodedOptions;
+        encodedOptions.rows = 5;
+        encodedOptions.cols = 5;
+        encodedOptions.seed = 3;
+        for (const auto& puzzle : WordSearch::GeneratePuzzles(encodedData, 4, encodedOptions))
+        {
+            for (size_t i = 0; i < puzzle.board.CellCount(); ++i)
+                ASSERT(puzzle.board.Data()[i] <= readAlphabet.Size(), true);
+        }
+
+        std::string decodedText;
+        WordSearch::AppendPuzzle(decodedText, WordSearch::Format::Text, encodedBoard, encodedWords, &readAlphabet);
+        ASSERT(decodedText.compare(0, 5, "kr\xc3\xa1l"), 0);
+
+        // compiled dictionary keeps alphabet of encoded words and its letter counts give the same fill
+        ASSERT(Dictionary::WriteCompiledDictionary(encodedData, "test-alphabet.tmp", true, &readAlphabet), true);
+        {
+            Dictionary::MappedDictionary mappedEncoded;
+            ASSERT(mappedEncoded.Open("test-alphabet.tmp"), true);
+            ASSERT(mappedEncoded.GetAlphabet().has_value(), true);
+            ASSERT(mappedEncoded.GetAlphabet()->Size(), readAlphabet.Size());
+            ASSERT(mappedEncoded.GetAlphabet()->Decode(encodedData[3][0]), readAlphabet.Decode(encodedData[3][0]));
+
+            auto storedDistribution = WordSearch::GetLetterDistribution(*mappedEncoded.GetLetterCounts());
+            ASSERT(storedDistribution.letters, distribution.letters);
+            ASSERT(storedDistribution.weights, distribution.weights);
+        }
+        std::remove("test-alphabet.tmp");
+
+        // service: one response line per request, in order of requests and repeatable by seed
+        auto serviceRequest = WordSearch::ParseServiceRequest(" id=a rows=8 cols=9 from=4 to=5 seed=3 fill=0 placement=slot\r");
+        ASSERT(serviceRequest.has_value(), true);
+        ASSERT(serviceRequest->id, std::string("a"));
+        ASSERT(serviceRequest->rows == 8 && serviceRequest->cols == 9 && serviceRequest->wordSizeFrom == 4 && serviceRequest->wordSizeTo == 5, true);
+        ASSERT(serviceRequest->seed, std::optional<uint64_t>(3));
+        ASSERT(serviceRequest->fill, false);
+        ASSERT(serviceRequest->placement == WordSearch::Placement::Slot, true);
+        ASSERT(WordSearch::ParseServiceRequest("rows=0").has_value(), false);
+        ASSERT(WordSearch::ParseServiceRequest("from=6 to=5").has_value(), false);
+        ASSERT(WordSearch::ParseServiceRequest("size=5").has_value(), false);
+        ASSERT(WordSearch::ParseServiceRequest("seed=x").has_value(), false);
+
+        ASSERT(Dictionary::WriteCompiledDictionary(batchData, "test-service.tmp"), true);
+        {
+            WordSearch::Service service;
+            ASSERT(service.AddDictionary("cz", "test-service.tmp"), true);
+            ASSERT(service.AddDictionary("missing", "missing-dictionary.tmp"), false);
+            service.Warm(8, 8);
+
+            auto response = service.Handle("id=7 rows=8 cols=8 seed=42");
+            ASSERT(response.compare(0, 10, "7 ok 42 {\""), 0);
+            ASSERT(response.back(), '\n');
+            ASSERT(service.Handle("id=7 dict=cz rows=8 cols=8 seed=42"), response);
+            ASSERT(service.Handle("id=8 dict=en"), std::string("8 error unknown dictionary\n"));
+            ASSERT(service.Handle("id=9 rows=1000"), std::string("9 error invalid request\n"));
+
+            std::stringstream requests, responses;
+            for (size_t i = 0; i < 20; ++i)
+                requests << "id=" << i << " rows=8 cols=8 seed=" << i << "\n\n";
+
+            service.Serve(requests, responses, 3);
+
+            std::string line;
+            for (size_t i = 0; i < 20; ++i)
+            {
+                ASSERT((bool)std::getline(responses, line), true);
+                ASSERT(line + "\n", service.Handle("id=" + std::to_string(i) + " rows=8 cols=8 seed=" + std::to_string(i)));
+            }
+            ASSERT((bool)std::getline(responses, line), false);
+        }
+        std::remove("test-service.tmp");
+
+        // service decodes UTF-8 dictionary, raw bytes above 127 are escaped in JSON
+        std::ofstream("test-service.tmp") << "\xc4\x8d\xc3\xa1p\nkr\xc3\xa1l\n\xc5\xbe\xc3\xa1\x62\x61\nkos\n";
+        {
+            WordSearch::Service service;
+            ASSERT(service.AddDictionary("cz", "test-service.tmp"), true);
+
+            auto response = service.Handle("id=1 rows=4 cols=4 from=3 to=4 seed=5");
+            ASSERT(response.compare(0, 7, "1 ok 5 "), 0);
+            ASSERT(Dictionary::Alphabet().AddLetters(response), true);
+            ASSERT(response.find("\xc3\xa1") != std::string::npos, true);
+        }
+        std::remove("test-service.tmp");
+
+        std::string rawJson;
+        WordSearch::AppendPuzzle(rawJson, WordSearch::Format::JsonLines, WordSearch::Board(1, 1), { "\xe1" });
+        ASSERT(rawJson, std::string("{\"rows\":1,\"cols\":1,\"grid\":[\".\"],\"words\":[\"\\u00e1\"]}\n"));
+
+        // pool: refilled in background up to high watermark, miss is generated by caller
+        {
+            WordSearch::PoolOptions poolOptions;
+            poolOptions.lowWatermark = 2;
+            poolOptions.highWatermark = 4;
+            poolOptions.threadCount = 2;
+            poolOptions.seed = 11;
+
+            WordSearch::PuzzlePool pool(batchData, poolOptions);
+            WordSearch::PoolKey poolKey;
+            poolKey.rows = 8;
+            poolKey.cols = 8;
+
+            auto missed = pool.Take({ 6, 6 });
+            ASSERT(pool.GetMetrics().misses, 1u);
+            ASSERT(missed.board.Rows(), 6u);
+
+            pool.Add(poolKey);
+            for (size_t i = 0; i < 1000 && pool.Ready(poolKey) < 4; ++i)
+                std::this_thread::sleep_for(std::chrono::milliseconds(1));
+            ASSERT(pool.Ready(poolKey), 4u);
+
+            WordSearch::BatchOptions pooledOptions;
+            pooledOptions.rows = 8;
+            pooledOptions.cols = 8;
+            for (size_t i = 0; i < 3; ++i)
+            {
+                auto pooled = pool.Take(poolKey);
+                auto repeated = WordSearch::GeneratePuzzle(batchData, pooled.seed, pooledOptions);
+                ASSERT(pooled.board, repeated.board);
+                ASSERT(pooled.words, repeated.words);
+            }
+
+            auto metrics = pool.GetMetrics();
+            ASSERT(metrics.hits, 3u);
+            ASSERT(metrics.refills >= 4, true);
+            ASSERT(metrics.maxRefillTime <= metrics.refillTime, true);
+
+            // board which is too large: worker survives and failure comes out of Take
+            WordSearch::PoolKey failingKey;
+            failingKey.rows = WordSearch::MAX_POOL_BOARD_SIZE + 1;
+            failingKey.cols = 1;
+            pool.Add(failingKey);
+
+            bool thrown = false;
+            for (size_t i = 0; i < 1000 && !thrown; ++i)
+            {
+                try
+                {
+                    pool.TryTake(failingKey);
+                    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+                }
+                catch (const std::invalid_argument&)
+                {
+                    thrown = true;
+                }
+            }
+            ASSERT(thrown, true);
+            ASSERT(pool.Take(poolKey).board.Rows(), 8u);
+        }
+
+        // fast kernels give the same results as reference implementations on random inputs
+        std::ostringstream differential;
+        ASSERT(Test::PrintDifferential(Test::RunDifferential(5, 4000), differential), true);
+
+        Random::Generator first(7), second(7);
+        for (size_t i = 0; i < 100; ++i)
+        {
+            auto value = first.Range(3, 5);
+            ASSERT(value >= 3 && value <= 5, true);
+            ASSERT(value, second.Range(3, 5));
+        }
     }
 }
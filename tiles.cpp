@@ -0,0 +1,255 @@
+#include "tiles.h"
+#include "finder.h"
+#include "parallel.h"
+#include <unordered_set>
+#include <unordered_map>
+#include <algorithm>
+
+namespace WordSearch
+{
+    // Rectangle of board cells generated as one tile.
+    struct Window
+    {
+        size_t row;
+        size_t col;
+        size_t rows;
+        size_t cols;
+    };
+
+    // Starts of tiles along side of size, first tile ends at offset (if it is not 0) and
+    // remainder shorter than half of tile is joined to the last tile.
+    std::vector<size_t> GetTileStarts(size_t size, size_t tileSize, size_t offset)
+    {
+        std::vector<size_t> result = { 0 };
+        for (size_t start = offset != 0 ? offset : tileSize; start < size; start += tileSize)
+            result.push_back(start);
+
+        if (result.size() > 1 && size - result.back() < tileSize / 2)
+            result.pop_back();
+
+        return result;
+    }
+
+    std::vector<Window> GetWindows(size_t rows, size_t cols, size_t tileSize, size_t offset)
+    {
+        auto rowStarts = GetTileStarts(rows, tileSize, offset);
+        auto colStarts = GetTileStarts(cols, tileSize, offset);
+
+        std::vector<Window> result;
+        for (size_t r = 0; r < rowStarts.size(); ++r)
+        {
+            size_t rowEnd = r + 1 < rowStarts.size() ? rowStarts[r + 1] : rows;
+
+            for (size_t c = 0; c < colStarts.size(); ++c)
+            {
+                size_t colEnd = c + 1 < colStarts.size() ? colStarts[c + 1] : cols;
+                result.push_back({ rowStarts[r], colStarts[c], rowEnd - rowStarts[r], colEnd - colStarts[c] });
+            }
+        }
+
+        return result;
+    }
+
+    bool Intersects(const Window& first, const Window& second)
+    {
+        return first.row < second.row + second.rows && second.row < first.row + first.rows
+            && first.col < second.col + second.cols && second.col < first.col + first.cols;
+    }
+
+    // Board cells covered by kept words, so letters of removed word which no other word uses can
+    // be cleared.
+    struct Coverage
+    {
+        std::vector<uint8_t> counts;
+
+        // Call function(cell index) for each cell of word of size on position.
+        template<class T>
+        static void ForEachCell(const Board& board, const Candidate& position, size_t size, T function)
+        {
+            auto index = (ptrdiff_t)board.Index(position.row, position.col);
+            for (size_t i = 0; i < size; ++i, index += board.Stride(position.dir))
+                function((size_t)index);
+        }
+
+        void Add(const Board& board, const Candidate& position, size_t size)
+        {
+            ForEachCell(board, position, size, [&](size_t cell) { counts[cell]++; });
+        }
+
+        void Remove(const Board& board, const Candidate& position, size_t size)
+        {
+            ForEachCell(board, position, size, [&](size_t cell) { counts[cell]--; });
+        }
+
+        // Clear cells of word of size on position not used by any kept word.
+        void Clear(Board& board, const Candidate& position, size_t size) const
+        {
+            ForEachCell(board, position, size, [&](size_t cell)
+                {
+                    if (counts[cell] == 0)
+                        board.Set(cell, 0);
+                });
+        }
+    };
+
+    std::tuple<Board, Words> PositionWordsTiled(Random::Generator& generator, const Dictionary::Data& data, size_t boardRows, size_t boardCols, const TileOptions& options, Stats* stats)
+    {
+        Board board(boardRows, boardCols);
+        Words words;
+
+        uint64_t seed = generator();
+        size_t tileSize = std::max(options.tileSize, Dictionary::MIN_WORD_SIZE);
+        size_t waveSize = std::max<size_t>(options.waveSize, 1);
+
+        // words kept on board with their positions, tiles are not allowed to place them again
+        std::unordered_set<std::string_view> placed;
+        std::unordered_map<std::string_view, Candidate> positions;
+        Coverage coverage{ std::vector<uint8_t>(board.CellCount()) };
+
+        PlacementPolicy policy = options.policy;
+        policy.excluded = &placed;
+
+        // tiles of previous pass and their words which stayed unique, words of tiles intersecting
+        // new tile may be on it, so they are passed to PositionWords to keep them unique
+        std::vector<Window> previousWindows;
+        std::vector<Words> previousWords;
+
+        for (size_t pass = 0; pass < 2; ++pass)
+        {
+            auto windows = GetWindows(boardRows, boardCols, tileSize, pass * (tileSize / 2));
+            std::vector<Words> windowWords(windows.size());
+            std::vector<std::vector<Candidate>> windowPositions(windows.size());
+            std::vector<Stats> windowStats(stats ? windows.size() : 0);
+
+            for (size_t wave = 0; wave < windows.size(); wave += waveSize)
+            {
+                size_t waveEnd = std::min(wave + waveSize, windows.size());
+
+                std::vector<Board> tiles(waveEnd - wave);
+                ParallelFor(waveEnd - wave, options.threadCount, [&](size_t offset)
+                    {
+                        size_t i = wave + offset;
+                        const auto& window = windows[i];
+                        Random::Generator windowGenerator(Random::DeriveSeed(Random::DeriveSeed(seed, pass), i));
+
+                        Words tileWords;
+                        for (size_t j = 0; j < previousWindows.size(); ++j)
+                        {
+                            if (Intersects(window, previousWindows[j]))
+                                tileWords.insert(std::end(tileWords), std::begin(previousWords[j]), std::end(previousWords[j]));
+                        }
+                        size_t knownCount = tileWords.size();
+
+                        Board tile(window.rows, window.cols);
+                        for (size_t r = 0; r < window.rows; ++r)
+                        {
+                            for (size_t c = 0; c < window.cols; ++c)
+                            {
+                                if (auto cell = board.Get(window.row + r, window.col + c))
+                                    tile.Set(r, c, cell);
+                            }
+                        }
+
+                        PositionWords(windowGenerator, data, tile, tileWords, options.wordSizeFrom, options.wordSizeTo, policy, stats ? &windowStats[i] : nullptr);
+
+                        // new words are unique on tile, palindrome is found twice, first position is used
+                        windowWords[i].assign(std::begin(tileWords) + knownCount, std::end(tileWords));
+                        windowPositions[i].resize(windowWords[i].size(), Candidate{ -1, -1, Direction::COUNT });
+                        for (const auto& occurrence : FindOccurrences(tile, windowWords[i]))
+                        {
+                            auto& position = windowPositions[i][occurrence.word];
+                            if (position.dir == Direction::COUNT)
+                                position = { occurrence.position.row + (int)window.row, occurrence.position.col + (int)window.col, occurrence.position.dir };
+                        }
+
+                        tiles[offset] = std::move(tile);
+                    });
+
+                // Board::Set updates shared free count and occupancy words, so tiles are written
+                // back by this thread only
+                for (size_t i = wave; i < waveEnd; ++i)
+                {
+                    const auto& window = windows[i];
+                    const auto& tile = tiles[i - wave];
+
+                    for (size_t r = 0; r < window.rows; ++r)
+                    {
+                        for (size_t c = 0; c < window.cols; ++c)
+                        {
+                            if (board.Get(window.row + r, window.col + c) != tile.Get(r, c))
+                                board.Set(window.row + r, window.col + c, tile.Get(r, c));
+                        }
+                    }
+                }
+
+                // tiles of wave did not see each other's words, the first tile keeps a word placed by several
+                std::vector<std::tuple<Candidate, size_t>> dropped;
+                for (size_t i = wave; i < waveEnd; ++i)
+                {
+                    size_t kept = 0;
+                    for (size_t j = 0; j < windowWords[i].size(); ++j)
+                    {
+                        auto word = windowWords[i][j];
+                        if (!placed.insert(word).second)
+                        {
+                            dropped.emplace_back(windowPositions[i][j], word.size());
+                            continue;
+                        }
+
+                        positions[word] = windowPositions[i][j];
+                        coverage.Add(board, windowPositions[i][j], word.size());
+                        words.push_back(word);
+                        windowWords[i][kept++] = word;
+                    }
+                    windowWords[i].resize(kept);
+                }
+
+                // cells are cleared once all kept words are covered, dropped word may share them
+                for (const auto& [position, size] : dropped)
+                    coverage.Clear(board, position, size);
+
+                if (stats)
+                    stats->removedWords += dropped.size();
+            }
+
+            for (const auto& tileStats : windowStats)
+                *stats += tileStats;
+
+            // reconcile seams: word may still be formed across tiles by letters of other words
+            auto counts = CountOccurrences(board, words);
+
+            std::unordered_set<std::string_view> duplicated;
+            for (size_t i = 0; i < words.size(); ++i)
+            {
+                if (counts[i] != 1)
+                    duplicated.insert(words[i]);
+            }
+
+            // removed words stay excluded, their other occurrence is still on board
+            for (auto word : duplicated)
+                coverage.Remove(board, positions[word], word.size());
+
+            for (auto word : duplicated)
+            {
+                coverage.Clear(board, positions[word], word.size());
+                positions.erase(word);
+            }
+
+            auto isDuplicated = [&duplicated](std::string_view word) { return duplicated.count(word) != 0; };
+
+            size_t count = words.size();
+            words.erase(std::remove_if(std::begin(words), std::end(words), isDuplicated), std::end(words));
+
+            if (stats)
+                stats->removedWords += count - words.size();
+
+            for (auto& tileWords : windowWords)
+                tileWords.erase(std::remove_if(std::begin(tileWords), std::end(tileWords), isDuplicated), std::end(tileWords));
+
+            previousWindows = std::move(windows);
+            previousWords = std::move(windowWords);
+        }
+
+        return { board, words };
+    }
+}
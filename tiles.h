@@ -0,0 +1,31 @@
+#pragma once
+#include <vector>
+#include "wordSearch.h"
+
+namespace WordSearch
+{
+    struct TileOptions
+    {
+        // side of square tile, each word lies inside one tile (or shifted tile, see PositionWordsTiled)
+        size_t tileSize = 16;
+        size_t wordSizeFrom = Dictionary::MIN_WORD_SIZE;
+        size_t wordSizeTo = Dictionary::MAX_WORD_SIZE;
+        PlacementPolicy policy;
+        // 0 means number of hardware threads
+        size_t threadCount = 0;
+        // tiles filled concurrently, result depends on it but not on threadCount
+        size_t waveSize = 16;
+    };
+
+    // Place words on a large board (hundreds to thousands of rows and columns) tile by tile.
+    // Board is covered by tiles in two passes, second pass is shifted by half of tile, so its tiles
+    // cover seams of the first one and words cross them. Tiles of one pass do not overlap, they are
+    // filled concurrently in waves of waveSize tiles, each by PositionWords with generator seeded
+    // from generator and tile number, so result does not depend on number of threads. Words placed
+    // by earlier waves are excluded from placement. Only candidate tables of tile sizes are created.
+    // Word placed by two tiles of one wave is kept by the first one. After each pass words occurring
+    // more than once on whole board (formed across seam) are removed. Letters of removed words not
+    // used by other words are cleared.
+    std::tuple<Board, Words> PositionWordsTiled(Random::Generator& generator, const Dictionary::Data& data, size_t boardRows, size_t boardCols,
+        const TileOptions& options = {}, Stats* stats = nullptr);
+}
@@ -1,179 +1,115 @@
 #include "wordSearch.h"
-#include <random>
 #include "dictionary.h"
+#include "duplicates.h"
+#include "candidates.h"
 #include <iostream>
-#include <iomanip>
+#include <algorithm>
+#include <bitset>
 
 namespace WordSearch
 {
-    // we process candidates to form data[direction][wordSize]
-    // reason is that we want to pick direction uniformly at random
-    using ProcessedCandidates = std::array<Candidates, (size_t)Direction::COUNT>;
+    using Clock = std::chrono::steady_clock;
 
-    using Rand = std::uniform_int_distribution<size_t>;
+    // Uniform value from [from, to].
+    struct Rand
+    {
+        Rand(size_t from, size_t to) : from(from), to(to) {}
+
+        size_t operator()(Random::Generator& generator) const { return generator.Range(from, to); }
 
-    std::random_device g_rd;
-    std::mt19937 g_mt(g_rd());
+        size_t from;
+        size_t to;
+    };
 
     // Number of times we will try to position random word on board before we fail.
     static constexpr size_t SAFETY_COUNT = 2000;
     // How fast we will decrease word length lower bound with unsuccessful attempts.
     static constexpr float WORD_SIZE_DECREMENT_FACTOR = 0.5f;
+    // Clock is read only on every n-th check of deadline, attempt on small board costs about as much.
+    static constexpr size_t DEADLINE_CHECK_PERIOD = 8;
 
-    std::vector<Candidate> GenerateCandidates(int boardRows, int boardCols, int wordSize)
+    // End of time budget of generation run, never passed if not set.
+    class Deadline
     {
-        std::vector<Candidate> result;
-        int countRow = (boardRows - wordSize + 1) * boardCols;
-        int countDiag = (boardRows - wordSize + 1) * (boardCols - wordSize + 1);
-
-        // Up
-        for (int r = wordSize - 1; r < boardRows; ++r)
-            for (int c = 0; c < boardCols; ++c)
-                result.push_back({ r, c, Direction::Up });
-
-        // Down
-        for (int r = 0; r < boardRows - wordSize + 1; ++r)
-            for (int c = 0; c < boardCols; ++c)
-                result.push_back({ r, c, Direction::Down });
-
-        // Left
-        for (int r = 0; r < boardRows; ++r)
-            for (int c = wordSize - 1; c < boardCols; ++c)
-                result.push_back({ r, c, Direction::Left });
+    public:
+        Deadline() = default;
+        explicit Deadline(Clock::time_point time) : m_time(time), m_set(true) {}
 
-        // Right
-        for (int r = 0; r < boardRows; ++r)
-            for (int c = 0; c < boardCols - wordSize + 1; ++c)
-                result.push_back({ r, c, Direction::Right });
-
-        // UpLeft
-        for (int r = wordSize - 1; r < boardRows; ++r)
-            for (int c = wordSize - 1; c < boardCols; ++c)
-                result.push_back({ r, c, Direction::UpLeft });
+        bool Passed()
+        {
+            if (m_set && !m_passed && m_checks++ % DEADLINE_CHECK_PERIOD == 0)
+                m_passed = Clock::now() >= m_time;
 
-        // UpRight
-        for (int r = wordSize - 1; r < boardRows; ++r)
-            for (int c = 0; c < boardCols - wordSize + 1; ++c)
-                result.push_back({ r, c, Direction::UpRight });
+            return m_passed;
+        }
 
-        // DownLeft
-        for (int r = 0; r < boardRows - wordSize + 1; ++r)
-            for (int c = wordSize - 1; c < boardCols; ++c)
-                result.push_back({ r, c, Direction::DownLeft });
+        // Read clock regardless of period, e.g. when stopping to tell timeout from other reasons.
+        bool PassedNow()
+        {
+            if (m_set && !m_passed)
+                m_passed = Clock::now() >= m_time;
 
-        // DownRight
-        for (int r = 0; r < boardRows - wordSize + 1; ++r)
-            for (int c = 0; c < boardCols - wordSize + 1; ++c)
-                result.push_back({ r, c, Direction::DownRight });
+            return m_passed;
+        }
 
-        return result;
-    }
+    private:
+        Clock::time_point m_time;
+        bool m_set = false;
+        bool m_passed = false;
+        size_t m_checks = 0;
+    };
 
-    using CharFunctionPrototype = bool(Board&, int row, int col, char character);
+    using CharFunctionPrototype = bool(Board& board, size_t index, uint8_t cell, char character);
 
-    // Call function for each row, col and char from word.
+    // Call function for each cell and char from word. Cells are walked from start index with direction stride.
     template<class T, class BOARD>
-    bool ApplyCharFunction(BOARD& board, const Candidate& position, const std::string& word, T function)
+    bool ApplyCharFunction(BOARD& board, const Candidate& position, std::string_view word, T function)
     {
-        if (position.dir == Direction::Up)
-        {
-            for (size_t i = 0; i < word.size(); ++i)
-            {
-                if (!function(board, position.row - i, position.col, word[i]))
-                    return false;
-            }
-        }
-        else if (position.dir == Direction::Down)
-        {
-            for (size_t i = 0; i < word.size(); ++i)
-            {
-                if (!function(board, position.row + i, position.col, word[i]))
-                    return false;
-            }
-        }
-        else if (position.dir == Direction::Left)
-        {
-            for (size_t i = 0; i < word.size(); ++i)
-            {
-                if (!function(board, position.row, position.col - i, word[i]))
-                    return false;
-            }
-        }
-        else if (position.dir == Direction::Right)
-        {
-            for (size_t i = 0; i < word.size(); ++i)
-            {
-                if (!function(board, position.row, position.col + i, word[i]))
-                    return false;
-            }
-        }
-        else if (position.dir == Direction::UpLeft)
-        {
-            for (size_t i = 0; i < word.size(); ++i)
-            {
-                if (!function(board, position.row - i, position.col - i, word[i]))
-                    return false;
-            }
-        }
-        else if (position.dir == Direction::UpRight)
-        {
-            for (size_t i = 0; i < word.size(); ++i)
-            {
-                if (!function(board, position.row - i, position.col + i, word[i]))
-                    return false;
-            }
-        }
-        else if (position.dir == Direction::DownLeft)
-        {
-            for (size_t i = 0; i < word.size(); ++i)
-            {
-                if (!function(board, position.row + i, position.col - i, word[i]))
-                    return false;
-            }
-        }
-        else if (position.dir == Direction::DownRight)
+        auto cells = board.Data();
+        auto stride = board.Stride(position.dir);
+        ptrdiff_t index = (ptrdiff_t)board.Index(position.row, position.col);
+
+        for (size_t i = 0; i < word.size(); ++i, index += stride)
         {
-            for (size_t i = 0; i < word.size(); ++i)
-            {
-                if (!function(board, position.row + i, position.col + i, word[i]))
-                    return false;
-            }
+            if (!function(board, (size_t)index, cells[index], word[i]))
+                return false;
         }
 
         return true;
     }
 
-    // Verify if it's possible to place word on position in board.
-    bool VerifyWord(const Board& board, const Candidate& position, const std::string& word)
+    // Verify if it's possible to place word on position in board. One-off check walks cells and
+    // stops at first mismatch, loops over many candidates prepare WordPattern once instead.
+    bool VerifyWord(const Board& board, const Candidate& position, std::string_view word)
     {
-        return ApplyCharFunction(board, position, word, [](const Board& board, int row, int col, char character)
+        return ApplyCharFunction(board, position, word, [](const Board&, size_t, uint8_t cell, char character)
             {
-                return board[row][col] == 0 || board[row][col] == character;
+                return cell == 0 || cell == (uint8_t)character;
             });
     }
 
     // Place word on position in board.
-    void ApplyWord(Board& board, const Candidate& position, const std::string& word)
+    void ApplyWord(Board& board, const Candidate& position, std::string_view word)
     {
-        ApplyCharFunction(board, position, word, [](Board& board, int row, int col, char character)
+        ApplyCharFunction(board, position, word, [](Board& board, size_t index, uint8_t, char character)
             {
-                board[row][col] = character;
+                board.Set(index, character);
 
                 return true;
             });
     }
 
     using ApplyIndices = std::vector<size_t>;
-    ApplyIndices ApplyWordIndices(Board& board, const Candidate& position, const std::string& word)
+    ApplyIndices ApplyWordIndices(Board& board, const Candidate& position, std::string_view word)
     {
         ApplyIndices res;
         size_t index = 0;
 
-        ApplyCharFunction(board, position, word, [&index, &res](Board& board, int row, int col, char character)
+        ApplyCharFunction(board, position, word, [&index, &res](Board& board, size_t cellIndex, uint8_t cell, char character)
             {
-                if (board[row][col] == 0)
+                if (cell == 0)
                 {
-                    board[row][col] = character;
+                    board.Set(cellIndex, character);
                     res.push_back(index);
                 }
 
@@ -185,16 +121,16 @@ namespace WordSearch
         return res;
     }
 
-    void UnapplyWordIndices(Board& board, const Candidate& position, const std::string& word, const ApplyIndices& indices)
+    void UnapplyWordIndices(Board& board, const Candidate& position, std::string_view word, const ApplyIndices& indices)
     {
         size_t index = 0;
         size_t indicesIndex = 0;
 
-        ApplyCharFunction(board, position, word, [&index, &indicesIndex, &indices](Board& board, int row, int col, char character)
+        ApplyCharFunction(board, position, word, [&index, &indicesIndex, &indices](Board& board, size_t cellIndex, uint8_t, char)
             {
                 if (indicesIndex < indices.size() && index == indices[indicesIndex])
                 {
-                    board[row][col] = 0;
+                    board.Set(cellIndex, 0);
                     indicesIndex++;
                 }
 
@@ -204,14 +140,14 @@ namespace WordSearch
             });
     }
 
-    // Count number of empty cells word will take on position in board.
-    size_t CountEmptyCells(const Board& board, const Candidate& position, const std::string& word)
+    // Count number of empty cells word will take on position in board. One-off count walks cells,
+    // computing span offset for Board::CountEmpty costs more than the walk.
+    size_t CountEmptyCells(const Board& board, const Candidate& position, std::string_view word)
     {
         size_t count = 0;
-
-        ApplyCharFunction(board, position, word, [&count](const Board& board, int row, int col, char character)
+        ApplyCharFunction(board, position, word, [&count](const Board&, size_t, uint8_t cell, char)
             {
-                count += board[row][col] == 0 ? 1 : 0;
+                count += cell == 0 ? 1 : 0;
 
                 return true;
             });
@@ -220,46 +156,37 @@ namespace WordSearch
     }
 
     // Check if word is present on position in board.
-    bool CheckWord(const Board& board, const Candidate& position, const std::string& word)
+    bool CheckWord(const Board& board, const Candidate& position, std::string_view word)
     {
-        bool result = true;
-
-        ApplyCharFunction(board, position, word, [&result](const Board& board, int row, int col, char character)
+        return ApplyCharFunction(board, position, word, [](const Board&, size_t, uint8_t cell, char character)
             {
-                result = board[row][col] == character;
-
-                return result;
+                return cell == (uint8_t)character;
             });
-
-        return result;
     }
 
-    void PrintBoard(const Board& board)
+    void PrintBoard(const Board& board, const Dictionary::Alphabet* alphabet)
     {
-        for (size_t r = 0; r < board.size(); ++r)
-        {
-            for (size_t c = 0; c < board[r].size(); ++c)
-            {
-                std::cout << std::setw(4) << (char)(board[r][c] == 0 ? '.' : board[r][c]);
-            }
-            std::cout << "\n";
-        }
-        std::cout << "\n";
-    }
-
-    ProcessedCandidates ProcessCandidates(Candidates&& candidates)
-    {
-        ProcessedCandidates result;
+        // whole board is formatted first and written at once
+        std::string text;
+        text.reserve((4 * board.Cols() + 1) * board.Rows() + 1);
 
-        for (size_t wordSize = 0; wordSize < candidates.size(); ++wordSize)
+        for (size_t r = 0; r < board.Rows(); ++r)
         {
-            for (auto&& candidate : candidates[wordSize])
+            for (size_t c = 0; c < board.Cols(); ++c)
             {
-                result[(size_t)candidate.dir][wordSize].push_back(std::move(candidate));
+                auto cell = (char)board.Get(r, c);
+
+                text.append(3, ' ');
+                if (alphabet)
+                    text.append(alphabet->Decode({ &cell, 1 }));
+                else
+                    text.push_back(cell == 0 ? '.' : cell);
             }
+            text.push_back('\n');
         }
+        text.push_back('\n');
 
-        return result;
+        std::cout.write(text.data(), (std::streamsize)text.size());
     }
 
     Candidates GetCandidates(size_t rows, size_t cols)
@@ -267,10 +194,7 @@ namespace WordSearch
         Candidates result;
 
         for (size_t i = Dictionary::MIN_WORD_SIZE; i < Dictionary::MAX_WORD_SIZE; ++i)
-        {
             result[i] = GenerateCandidates(rows, cols, i);
-            std::shuffle(std::begin(result[i]), std::end(result[i]), g_mt);
-        }
 
         return result;
     }
@@ -423,15 +347,44 @@ namespace WordSearch
         removeItercepting((size_t)GetOpositeDirection(candidate.dir));
     }
 
+    // Return first live candidate satisfying predicate, candidates are visited in random order.
+    // Order is shuffled lazily (Fisher-Yates), so only visited candidates are shuffled. Removed
+    // candidates met on the way are dropped from live list. Predicate gets candidate and offset
+    // of its span in Board::Mirror.
+    template<class T>
+    std::optional<Candidate> FindRandomCandidate(Random::Generator& generator, CandidateView& candidates, Direction dir, size_t size, T predicate)
+    {
+        auto& live = candidates.Live(dir, size);
+
+        for (size_t i = 0; i < live.size();)
+        {
+            std::swap(live[i], live[generator.Range(i, live.size() - 1)]);
+
+            if (!candidates.IsLive(dir, size, live[i]))
+            {
+                live[i] = live.back();
+                live.pop_back();
+                continue;
+            }
+
+            const auto& candidate = candidates.Get(dir, size, live[i]);
+            if (predicate(candidate, candidates.SpanOffset(dir, size, live[i++])))
+                return candidate;
+        }
+
+        return std::nullopt;
+    }
+
     bool IsAnyWordDuplicated(const Board& board, const Words& words, const Candidates& candidates)
     {
         for (const auto& word : words)
         {
             size_t count = 0;
+            WordPattern pattern(word);
 
             for (const auto& candidate : candidates[word.size()])
             {
-                if (CheckWord(board, candidate, word))
+                if (MatchWord(board, candidate, pattern).equal)
                     count++;
 
                 if (count > 1)
@@ -442,8 +395,9 @@ namespace WordSearch
         return false;
     }
 
-    bool VerifyDuplication(const Board& board, const Words& words, const Candidate& position, const std::string& newWord, const Candidates& candidates)
+    bool VerifyDuplication(const Board& board, const Words& words, const Candidate& position, std::string_view newWord, const Candidates& candidates)
     {
+        // single memcpy of the contiguous cell buffer
         Board tempBoard(board);
         ApplyWord(tempBoard, position, newWord);
         if (IsAnyWordDuplicated(tempBoard, words, candidates) || IsAnyWordDuplicated(tempBoard, { newWord }, candidates))
@@ -458,169 +412,544 @@ namespace WordSearch
         return Rand(std::max((int)from, (int)to - 1 - (int)(safetyCount * WORD_SIZE_DECREMENT_FACTOR)), to);
     }
 
-    bool PositionWordRandom(Dictionary::Data& data, Board& board, Words& words, ProcessedCandidates& candidates, size_t wordSizeFrom, size_t wordSizeTo, Rand randDir, const Candidates& checkCandidates)
+    Stats& Stats::operator+=(const Stats& other)
     {
+        attempts += other.attempts;
+        missingWords += other.missingWords;
+        repeatedWords += other.repeatedWords;
+        presentWords += other.presentWords;
+        exhaustedCandidates += other.exhaustedCandidates;
+
+        candidatesScanned += other.candidatesScanned;
+        rejectedLetters += other.rejectedLetters;
+        rejectedNoEmptyCell += other.rejectedNoEmptyCell;
+        rejectedDuplication += other.rejectedDuplication;
+
+        placements += other.placements;
+        diagonalPlacements += other.diagonalPlacements;
+
+        filledCells += other.filledCells;
+        restrictedCells += other.restrictedCells;
+        unfillableCells += other.unfillableCells;
+
+        removedWords += other.removedWords;
+
+        setupTime += other.setupTime;
+        diagonalTime += other.diagonalTime;
+        straightTime += other.straightTime;
+        fillTime += other.fillTime;
+
+        return *this;
+    }
+
+    bool PositionWordRandom(Random::Generator& generator, const Dictionary::Data& data, Board& board, Words& words, CandidateView& candidates, size_t wordSizeFrom, size_t wordSizeTo, Rand randDir, DuplicateDetector& duplicates, const PlacementPolicy& policy, Deadline& deadline, Stats& stats)
+    {
+        bool overlapping = policy.placement == Placement::Overlap && policy.topK != 0;
+        // feasible candidates reusing most letters, sorted by overlap (only for Overlap placement)
+        std::vector<std::tuple<size_t, Candidate>> best;
+
         size_t safetyCounter = 0;
 
-        while (safetyCounter < SAFETY_COUNT)
+        while (safetyCounter < SAFETY_COUNT && !deadline.Passed())
         {
-            auto direction = randDir(g_mt);
-            auto word = Dictionary::GetRandomWord(data, GetRandWordSize(wordSizeFrom, wordSizeTo, safetyCounter)(g_mt));
+            auto direction = (Direction)randDir(generator);
+            auto word = Dictionary::GetRandomWord(generator, data, GetRandWordSize(wordSizeFrom, wordSizeTo, safetyCounter)(generator));
 
-            if (std::find(std::begin(words), std::end(words), *word) != std::end(words))
-                continue;
+            stats.attempts++;
 
-            std::shuffle(std::begin(candidates[direction][word->size()]), std::end(candidates[direction][word->size()]), g_mt);
+            if (!word)
+            {
+                stats.missingWords++;
+                safetyCounter++;
+                continue;
+            }
 
-            for (auto it = std::begin(candidates[direction][word->size()]); it != std::end(candidates[direction][word->size()]); it++)
+            // repeated draws count as failed attempts, otherwise loop never ends once all words are used
+            if (std::find(std::begin(words), std::end(words), *word) != std::end(words) || (policy.excluded && policy.excluded->count(*word) != 0))
             {
-                if (VerifyWord(board, *it, *word) && CountEmptyCells(board, *it, *word) != 0)
+                stats.repeatedWords++;
+                safetyCounter++;
+                continue;
+            }
+
+            // Word is checked for presence on board only when first feasible position is found.
+            bool pending = false;
+            bool present = false;
+
+            WordPattern pattern(*word);
+            best.clear();
+
+            auto position = FindRandomCandidate(generator, candidates, direction, word->size(), [&](const Candidate& candidate, uint32_t span)
                 {
-                    if (!VerifyDuplication(board, words, *it, *word, checkCandidates))
-                        continue;
+                    stats.candidatesScanned++;
+
+                    auto match = pattern.Match(board.Mirror() + span);
+
+                    if (!match.fits)
+                    {
+                        stats.rejectedLetters++;
+                        return false;
+                    }
+
+                    if (match.emptyCount == 0)
+                    {
+                        stats.rejectedNoEmptyCell++;
+                        return false;
+                    }
+
+                    if (!pending)
+                    {
+                        pending = true;
+                        present = !duplicates.SetPendingWord(board, *word);
+                    }
 
-                    ApplyWord(board, *it, *word);
-                    RemoveInterceptingCandidates(*it, word->size(), candidates);
-                    words.push_back(std::move(*word));
+                    // stop search if word is already on board
+                    if (present)
+                        return true;
+
+                    if (overlapping)
+                    {
+                        // candidates are visited in random order, so ties are broken randomly
+                        size_t overlap = word->size() - match.emptyCount;
+                        auto it = std::find_if(std::begin(best), std::end(best), [overlap](const auto& item) { return std::get<0>(item) < overlap; });
+
+                        if (best.size() < policy.topK || it != std::end(best))
+                        {
+                            best.insert(it, { overlap, candidate });
+                            if (best.size() > policy.topK)
+                                best.pop_back();
+                        }
+
+                        // no candidate can reuse more letters
+                        return best.size() == policy.topK && std::get<0>(best.back()) == word->size() - 1;
+                    }
+
+                    if (!duplicates.VerifyPlacement(board, candidate))
+                    {
+                        stats.rejectedDuplication++;
+                        return false;
+                    }
 
                     return true;
+                });
+
+            if (overlapping && !present)
+            {
+                // pick randomly from top candidates, duplication is verified only for them
+                generator.Shuffle(std::begin(best), std::end(best));
+                position.reset();
+
+                for (const auto& item : best)
+                {
+                    if (duplicates.VerifyPlacement(board, std::get<1>(item)))
+                    {
+                        position = std::get<1>(item);
+                        break;
+                    }
+
+                    stats.rejectedDuplication++;
                 }
             }
 
+            if (position && !present)
+            {
+                ApplyWord(board, *position, *word);
+                candidates.RemoveIntercepting(board, *position, word->size());
+                duplicates.AddWord(board, *word, *position);
+                words.push_back(*word);
+
+                stats.placements++;
+                return true;
+            }
+
+            if (present)
+                stats.presentWords++;
+            else
+                stats.exhaustedCandidates++;
+
             safetyCounter++;
         }
 
         return false;
     }
 
-    std::tuple<Board, Words> PositionWords(Dictionary::Data& data, size_t boardRows, size_t boardCols, size_t wordSizeFrom, size_t wordSizeTo)
+    bool PositionWordSlot(Random::Generator& generator, Board& board, Words& words, CandidateView& candidates, size_t wordSizeFrom, size_t wordSizeTo, Rand randDir, DuplicateDetector& duplicates, const PlacementPolicy& policy, Deadline& deadline, Stats& stats)
     {
+        size_t safetyCounter = 0;
+
+        for (; safetyCounter < SAFETY_COUNT && !deadline.Passed(); ++safetyCounter)
+        {
+            auto direction = (Direction)randDir(generator);
+            size_t size = GetRandWordSize(wordSizeFrom, wordSizeTo, safetyCounter)(generator);
+
+            stats.attempts++;
+
+            if (size >= Dictionary::MAX_WORD_SIZE)
+            {
+                stats.missingWords++;
+                continue;
+            }
+
+            // random live slot with at least one empty cell
+            const uint8_t* pattern = nullptr;
+
+            auto position = FindRandomCandidate(generator, candidates, direction, size, [&](const Candidate&, uint32_t span)
+                {
+                    stats.candidatesScanned++;
+                    pattern = board.Mirror() + span;
+
+                    if (board.CountEmpty(span, size) == 0)
+                    {
+                        stats.rejectedNoEmptyCell++;
+                        return false;
+                    }
+
+                    return true;
+                });
+
+            if (!position)
+            {
+                stats.exhaustedCandidates++;
+                continue;
+            }
+
+            auto word = policy.index->GetRandomMatch(generator, pattern, size);
+
+            if (!word)
+            {
+                stats.missingWords++;
+                continue;
+            }
+
+            if (std::find(std::begin(words), std::end(words), *word) != std::end(words) || (policy.excluded && policy.excluded->count(*word) != 0))
+            {
+                stats.repeatedWords++;
+                continue;
+            }
+
+            if (!duplicates.SetPendingWord(board, *word))
+            {
+                stats.presentWords++;
+                continue;
+            }
+
+            if (!duplicates.VerifyPlacement(board, *position))
+            {
+                stats.rejectedDuplication++;
+                continue;
+            }
+
+            ApplyWord(board, *position, *word);
+            candidates.RemoveIntercepting(board, *position, word->size());
+            duplicates.AddWord(board, *word, *position);
+            words.push_back(*word);
+
+            stats.placements++;
+            return true;
+        }
+
+        return false;
+    }
+
+    std::tuple<Board, Words> PositionWords(Random::Generator& generator, const Dictionary::Data& data, size_t boardRows, size_t boardCols, size_t wordSizeFrom, size_t wordSizeTo, const PlacementPolicy& policy, Stats* stats)
+    {
+        Board board(boardRows, boardCols);
+        Words words;
+
+        PositionWords(generator, data, board, words, wordSizeFrom, wordSizeTo, policy, stats);
+
+        return { board, words };
+    }
+
+    // Targets which are set are reached, false if none is set.
+    bool IsTargetReached(const Board& board, size_t wordCount, double targetDensity, size_t targetWords)
+    {
+        size_t covered = board.CellCount() - board.FreeCellCount();
+        bool density = targetDensity <= 0 || covered >= targetDensity * board.CellCount();
+        bool count = targetWords == 0 || wordCount >= targetWords;
+
+        return (targetDensity > 0 || targetWords != 0) && density && count;
+    }
+
+    // Place words until no more fit, deadline passes or targets (which are set) are reached.
+    // Return false if deadline passed.
+    bool PositionWords(Random::Generator& generator, const Dictionary::Data& data, Board& board, Words& words, size_t wordSizeFrom, size_t wordSizeTo, const PlacementPolicy& policy, Deadline& deadline, double targetDensity, size_t targetWords, Stats* stats)
+    {
+        // counters are cheap, they are collected always and time only when requested
+        Stats localStats;
+        Stats& counters = stats ? *stats : localStats;
+        auto phaseStart = stats ? Clock::now() : Clock::time_point();
+
+        auto endPhase = [&](std::chrono::nanoseconds& time)
+        {
+            if (!stats)
+                return;
+
+            auto now = Clock::now();
+            time += now - phaseStart;
+            phaseStart = now;
+        };
+
         Rand randDirStraight(0, (size_t)Direction::Right);
         Rand randDirDiagonal((size_t)Direction::UpLeft, (size_t)Direction::DownRight);
 
-        size_t maxWordSizeTo = std::min(std::max(boardRows, boardCols), wordSizeTo);
+        size_t maxWordSizeTo = std::min(std::max(board.Rows(), board.Cols()), wordSizeTo);
 
-        ProcessedCandidates candidates = ProcessCandidates(GetCandidates(boardRows, boardCols));
-        Candidates checkCandidates = GetCandidates(boardRows, boardCols);
+        // setup stages are not interrupted, deadline is checked between them
+        if (deadline.PassedNow())
+            return false;
 
-        Board board(boardRows, std::vector<uint8_t>(boardCols, 0));
-        Words words;
+        CandidateView candidates(GetCandidateTable(board.Rows(), board.Cols()));
+        if (deadline.PassedNow())
+            return false;
 
-        size_t totalCells = boardRows * boardCols;
-        size_t freeCells = totalCells;
+        DuplicateDetector duplicates(board, words);
+        if (deadline.PassedNow())
+            return false;
+
+        size_t totalCells = board.CellCount();
+        size_t freeCells = GetFreeCellsCount(board);
         // First is positioned with diagonal words.
-        Rand currentRandDir = randDirDiagonal;
+        bool diagonal = freeCells >= totalCells / 2;
+        Rand currentRandDir = diagonal ? randDirDiagonal : randDirStraight;
 
-        while (PositionWordRandom(data, board, words, candidates, wordSizeFrom, maxWordSizeTo, currentRandDir, checkCandidates))
+        endPhase(counters.setupTime);
+
+        while (!IsTargetReached(board, words.size(), targetDensity, targetWords))
         {
+            bool placed = policy.placement == Placement::Slot && policy.index
+                ? PositionWordSlot(generator, board, words, candidates, wordSizeFrom, maxWordSizeTo, currentRandDir, duplicates, policy, deadline, counters)
+                : PositionWordRandom(generator, data, board, words, candidates, wordSizeFrom, maxWordSizeTo, currentRandDir, duplicates, policy, deadline, counters);
+            endPhase(diagonal ? counters.diagonalTime : counters.straightTime);
+
+            if (!placed)
+                return !deadline.PassedNow();
+
+            counters.diagonalPlacements += diagonal ? 1 : 0;
             freeCells = GetFreeCellsCount(board);
 
             // After half of the cells are positioned we will switch to horizontal/vertical direction.
             if (freeCells < totalCells / 2)
+            {
                 currentRandDir = randDirStraight;
+                diagonal = false;
+            }
         }
 
-        return { board, words };
+        return true;
+    }
+
+    void PositionWords(Random::Generator& generator, const Dictionary::Data& data, Board& board, Words& words, size_t wordSizeFrom, size_t wordSizeTo, const PlacementPolicy& policy, Stats* stats)
+    {
+        Deadline deadline;
+        PositionWords(generator, data, board, words, wordSizeFrom, wordSizeTo, policy, deadline, 0, 0, stats);
     }
 
-    std::array<Direction, (size_t)Direction::COUNT> GetShuffledDirections()
+    GenerationResult PositionWords(Random::Generator& generator, const Dictionary::Data& data, size_t boardRows, size_t boardCols, size_t wordSizeFrom, size_t wordSizeTo, const GenerationLimits& limits, const PlacementPolicy& policy, Stats* stats)
     {
-        std::array<Direction, (size_t)Direction::COUNT> dirs
+        std::optional<Clock::time_point> time = limits.deadline;
+        if (limits.maxTime.count() != 0)
+            time = std::min(time.value_or(Clock::time_point::max()), Clock::now() + limits.maxTime);
+
+        Deadline deadline = time ? Deadline(*time) : Deadline();
+
+        GenerationResult result;
+        result.board = Board(boardRows, boardCols);
+        bool finished = PositionWords(generator, data, result.board, result.words, wordSizeFrom, wordSizeTo, policy, deadline, limits.targetDensity, limits.targetWords, stats);
+
+        result.timedOut = !finished;
+        result.targetReached = limits.targetDensity > 0 || limits.targetWords != 0
+            ? IsTargetReached(result.board, result.words.size(), limits.targetDensity, limits.targetWords)
+            : finished;
+
+        return result;
+    }
+
+    size_t GetFreeCellsCount(const Board& board)
+    {
+        return board.FreeCellCount();
+    }
+
+    LetterDistribution GetLatinLetters()
+    {
+        LetterDistribution result;
+        for (char letter = 'a'; letter <= 'z'; ++letter)
         {
-            Direction::Up, Direction::Down, Direction::Left, Direction::Right, Direction::UpLeft, Direction::UpRight, Direction::DownLeft, Direction::DownRight
-        };
-        std::shuffle(std::begin(dirs), std::end(dirs), g_mt);
+            result.letters.push_back((uint8_t)letter);
+            result.weights.push_back(1);
+        }
+
+        return result;
+    }
 
-        return dirs;
+    LetterDistribution GetLetterDistribution(const Dictionary::Data& data)
+    {
+        return GetLetterDistribution(Dictionary::CountLetters(data));
     }
 
-    void CopyCandidates(const ProcessedCandidates& from, ProcessedCandidates& to)
+    LetterDistribution GetLetterDistribution(const Dictionary::LetterCounts& counts)
     {
-        for (size_t dir = 0; dir < from.size(); ++dir)
+        std::vector<uint8_t> letters;
+        for (size_t letter = 1; letter < counts.size(); ++letter)
         {
-            for (size_t size = 0; size < from[dir].size(); ++size)
-            {
-                if (to[dir][size].size() == from[dir][size].size())
-                    continue;
+            if (counts[letter] != 0)
+                letters.push_back((uint8_t)letter);
+        }
 
-                to[dir][size].resize(from[dir][size].size());
-                for (size_t i = 0; i < from[dir][size].size(); ++i)
-                    to[dir][size][i] = from[dir][size][i];
-            }
+        // most frequent letters if there are too many
+        std::stable_sort(std::begin(letters), std::end(letters), [&counts](uint8_t first, uint8_t second) { return counts[first] > counts[second]; });
+        letters.resize(std::min(letters.size(), MAX_FILL_LETTERS));
+        std::sort(std::begin(letters), std::end(letters));
+
+        LetterDistribution result;
+        for (auto letter : letters)
+        {
+            result.letters.push_back(letter);
+            result.weights.push_back(counts[letter]);
         }
+
+        return result;
     }
 
-    bool PositionWordsBacktrack(Board& board, const Words& words, size_t wordIndex, const ProcessedCandidates& candidates, const Candidates& checkCandidates)
+    // Return mask of letters (bit i is letters.letters[i]) which do not complete any word when written
+    // to empty cell. Only letters of used mask (letters of words) can complete a word. Only
+    // occurrences going through the cell are new, so only its four lines are scanned, each in
+    // a window of longest word size around the cell.
+    uint64_t GetAllowedLetters(const Board& board, const WordAutomaton& automaton, size_t maxWordSize, size_t row, size_t col, const LetterDistribution& letters, uint64_t used)
     {
-        if (words.size() == wordIndex)
-            return true;
+        size_t letterCount = letters.letters.size();
+        uint64_t allowed = letterCount == 64 ? ~0ull : (1ull << letterCount) - 1;
+        auto cells = board.Data();
+        auto lines = board.GetCellLines(row, col);
+        auto positions = board.GetCellLinePositions(row, col);
 
-        ProcessedCandidates tempCandidates = candidates;
-
-        for (auto dir : GetShuffledDirections())
+        for (size_t i = 0; i < lines.size(); ++i)
         {
-            for (auto it = std::begin(candidates[(size_t)dir][words[wordIndex].size()]); it != std::end(candidates[(size_t)dir][words[wordIndex].size()]); it++)
-            {
-                if (VerifyWord(board, *it, words[wordIndex]) && CountEmptyCells(board, *it, words[wordIndex]) != 0)
-                {
-                    // This takes long time, temporarily disabled
-                    //if (!VerifyDuplication(board, words, *it, word, checkCandidates))
-                    //    continue;
+            auto line = board.GetLine(lines[i]);
+            size_t position = positions[i];
+
+            // first letter of window before cell
+            size_t first = position;
+            while (first > 0 && position - first + 1 < maxWordSize && cells[line.start + (first - 1) * line.stride] != 0)
+                first--;
+
+            // last letter of window after cell
+            size_t last = position;
+            while (last + 1 < line.length && last - position + 1 < maxWordSize && cells[line.start + (last + 1) * line.stride] != 0)
+                last++;
+
+            WordAutomaton::State prefix = 0;
+            for (size_t p = first; p < position; ++p)
+                prefix = automaton.Next(prefix, cells[line.start + p * line.stride]);
 
-                    auto applyIndices = ApplyWordIndices(board, *it, words[wordIndex]);
+            for (uint64_t rest = allowed & used; rest != 0; rest &= rest - 1)
+            {
+                size_t letter = LowestBit(rest);
+                auto state = automaton.Next(prefix, letters.letters[letter]);
 
-                    CopyCandidates(candidates, tempCandidates);
-                    RemoveInterceptingCandidates(*it, words[wordIndex].size(), tempCandidates);
+                for (size_t p = position; p <= last; ++p)
+                {
+                    if (p != position)
+                        state = automaton.Next(state, cells[line.start + p * line.stride]);
 
-                    if (auto resBoard = PositionWordsBacktrack(board, words, wordIndex + 1, tempCandidates, checkCandidates))
-                        return resBoard;
+                    bool found = false;
+                    for (auto it = automaton.MatchesBegin(state); it != automaton.MatchesEnd(state) && !found; ++it)
+                        found = p + 1 <= position + automaton.WordSize(*it);
 
-                    UnapplyWordIndices(board, *it, words[wordIndex], applyIndices);
+                    if (found)
+                    {
+                        allowed &= ~(1ull << letter);
+                        break;
+                    }
                 }
             }
         }
 
-        return false;
+        return allowed;
     }
 
-    std::optional<Board> PositionWords(size_t boardRows, size_t boardCols, const Words& words)
+    std::vector<std::tuple<size_t, size_t>> FillFreeCellsRandom(Random::Generator& generator, Board& board, const Words& words, Stats* stats)
     {
-        ProcessedCandidates candidates = ProcessCandidates(GetCandidates(boardRows, boardCols));
-        Candidates checkCandidates = GetCandidates(boardRows, boardCols);
-        Board board(boardRows, std::vector<uint8_t>(boardCols, 0));
-
-        if (PositionWordsBacktrack(board, words, 0, candidates, checkCandidates))
-            return board;
+        static const LetterDistribution latin = GetLatinLetters();
 
-        return std::nullopt;
+        return FillFreeCellsRandom(generator, board, words, latin, stats);
     }
 
-    size_t GetFreeCellsCount(const Board& board)
+    std::vector<std::tuple<size_t, size_t>> FillFreeCellsRandom(Random::Generator& generator, Board& board, const Words& words, const LetterDistribution& letters, Stats* stats)
     {
-        size_t res = 0;
+        auto start = stats ? Clock::now() : Clock::time_point();
 
-        for (size_t r = 0; r < board.size(); ++r)
-            for (size_t c = 0; c < board[r].size(); ++c)
-                res += board[r][c] == 0 ? 1 : 0;
-        return res;
-    }
+        WordAutomaton automaton(words);
+        size_t maxWordSize = 0;
+        for (const auto& word : words)
+            maxWordSize = std::max(maxWordSize, word.size());
 
-    void FillFreeCellsRandom(Board& board, const Words& words)
-    {
-        Rand randChar(97, 122);
-        auto candidates = GetCandidates(board.size(), board[0].size());
+        // bit of each letter, 0 for other characters
+        std::array<uint64_t, 256> letterBits{};
+        for (size_t i = 0; i < letters.letters.size(); ++i)
+            letterBits[letters.letters[i]] = 1ull << i;
 
-        for (size_t r = 0; r < board.size(); ++r)
+        uint64_t used = 0;
+        for (const auto& word : words)
         {
-            for (size_t c = 0; c < board[r].size(); ++c)
+            for (auto character : word)
+                used |= letterBits[(uint8_t)character];
+        }
+
+        bool uniform = std::all_of(std::begin(letters.weights), std::end(letters.weights), [&letters](uint64_t weight) { return weight == letters.weights[0]; });
+
+        std::vector<std::tuple<size_t, size_t>> result;
+
+        for (size_t r = 0; r < board.Rows(); ++r)
+        {
+            for (size_t c = 0; c < board.Cols(); ++c)
             {
-                if (board[r][c] != 0)
+                if (board.Get(r, c) != 0)
                     continue;
 
-                board[r][c] = (uint8_t)randChar(g_mt);
-                while(IsAnyWordDuplicated(board, words, candidates))
-                    board[r][c] = (uint8_t)randChar(g_mt);
+                auto allowed = GetAllowedLetters(board, automaton, maxWordSize, r, c, letters, used);
+
+                size_t allowedCount = PopCount(allowed);
+
+                if (stats && allowedCount < letters.letters.size())
+                    stats->restrictedCells++;
+
+                if (allowedCount == 0)
+                {
+                    result.push_back({ r, c });
+                    continue;
+                }
+
+                // allowed letter by weight, n-th allowed letter if weights are equal
+                uint64_t rest = allowed;
+                if (uniform)
+                {
+                    for (auto n = generator.Range(0, allowedCount - 1); n != 0; --n)
+                        rest &= rest - 1;
+                }
+                else
+                {
+                    uint64_t total = 0;
+                    for (uint64_t bits = allowed; bits != 0; bits &= bits - 1)
+                        total += letters.weights[LowestBit(bits)];
+
+                    for (auto n = generator.Range(0, total - 1); n >= letters.weights[LowestBit(rest)]; rest &= rest - 1)
+                        n -= letters.weights[LowestBit(rest)];
+                }
+
+                board.Set(r, c, letters.letters[LowestBit(rest)]);
+
+                if (stats)
+                    stats->filledCells++;
             }
         }
+
+        if (stats)
+        {
+            stats->unfillableCells += result.size();
+            stats->fillTime += Clock::now() - start;
+        }
+
+        return result;
     }
 }
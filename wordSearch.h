@@ -1,39 +1,154 @@
 #pragma once
 #include <vector>
 #include <string>
+#include <string_view>
+#include <tuple>
+#include <chrono>
+#include <optional>
+#include <unordered_set>
 #include "dictionary.h"
+#include "alphabet.h"
+#include "board.h"
+#include "match.h"
 
 namespace WordSearch
 {
-    using Board = std::vector<std::vector<uint8_t>>;
-    using Words = std::vector<std::string>;
+    using Words = std::vector<std::string_view>;
 
-    std::optional<Board> PositionWords(size_t boardRows, size_t boardCols, const Words& words);
-    std::tuple<Board, Words> PositionWords(Dictionary::Data& data, size_t boardRows, size_t boardCols,
-        size_t wordSizeFrom = Dictionary::MIN_WORD_SIZE, size_t wordSizeTo = Dictionary::MAX_WORD_SIZE);
+    // Limits of exact placement of fixed word list, zero means unlimited.
+    struct SolverLimits
+    {
+        // number of tried placements
+        size_t maxNodes = 0;
+        std::chrono::milliseconds maxTime{ 0 };
+    };
 
-    void PrintBoard(const Board& board);
+    // Counters of generation, they are added to so one instance can collect many runs.
+    struct Stats
+    {
+        // PositionWords: words drawn from dictionary and why they were not placed
+        size_t attempts = 0;
+        size_t missingWords = 0;
+        size_t repeatedWords = 0;
+        size_t presentWords = 0;
+        size_t exhaustedCandidates = 0;
 
-    size_t GetFreeCellsCount(const Board& board);
-    void FillFreeCellsRandom(Board& board, const Words& words);
+        // PositionWords: candidates tried for drawn words and why they were rejected
+        size_t candidatesScanned = 0;
+        size_t rejectedLetters = 0;
+        size_t rejectedNoEmptyCell = 0;
+        size_t rejectedDuplication = 0;
 
-    // detail
+        size_t placements = 0;
+        size_t diagonalPlacements = 0;
 
-    // !!! this is here only because of test ):
-    enum class Direction
+        // FillFreeCellsRandom: cells where some letters had to be excluded, cells left empty
+        size_t filledCells = 0;
+        size_t restrictedCells = 0;
+        size_t unfillableCells = 0;
+
+        // PositionWordsTiled: words removed because they occur more than once on whole board
+        size_t removedWords = 0;
+
+        std::chrono::nanoseconds setupTime{ 0 };
+        std::chrono::nanoseconds diagonalTime{ 0 };
+        std::chrono::nanoseconds straightTime{ 0 };
+        std::chrono::nanoseconds fillTime{ 0 };
+
+        Stats& operator+=(const Stats& other);
+    };
+
+    enum class Placement
+    {
+        // first feasible candidate in random order
+        Random,
+        // random one of topK feasible candidates reusing most letters already on board
+        Overlap,
+        // random candidate (slot) first, then random word fitting letters already in it (needs index)
+        Slot
+    };
+
+    struct PlacementPolicy
     {
-        Up = 0,
-        Down,
-        Left,
-        Right,
-        UpLeft,
-        UpRight,
-        DownLeft,
-        DownRight,
+        Placement placement = Placement::Random;
+        size_t topK = 4;
+        // index of dictionary passed to PositionWords, used by Slot placement
+        const Dictionary::PatternIndex* index = nullptr;
+        // words which must not be placed, e.g. placed elsewhere on larger board (see PositionWordsTiled)
+        const std::unordered_set<std::string_view>* excluded = nullptr;
+    };
+
+    // Place all words on board, return nullopt if it is not possible or limits were reached.
+    std::optional<Board> PositionWords(Random::Generator& generator, size_t boardRows, size_t boardCols, const Words& words, const SolverLimits& limits = {});
+    std::tuple<Board, Words> PositionWords(Random::Generator& generator, const Dictionary::Data& data, size_t boardRows, size_t boardCols,
+        size_t wordSizeFrom = Dictionary::MIN_WORD_SIZE, size_t wordSizeTo = Dictionary::MAX_WORD_SIZE,
+        const PlacementPolicy& policy = {}, Stats* stats = nullptr);
+    // Place words on board which may already contain letters (e.g. window of larger board, see
+    // PositionWordsTiled). Words already on board are passed in words, they are kept unique and
+    // placed words are appended.
+    void PositionWords(Random::Generator& generator, const Dictionary::Data& data, Board& board, Words& words,
+        size_t wordSizeFrom = Dictionary::MIN_WORD_SIZE, size_t wordSizeTo = Dictionary::MAX_WORD_SIZE,
+        const PlacementPolicy& policy = {}, Stats* stats = nullptr);
 
-        COUNT
+    // Limits of anytime generation, zero means not set.
+    struct GenerationLimits
+    {
+        // time budget from start of generation, deadline may be given instead (earlier one applies)
+        std::chrono::milliseconds maxTime{ 0 };
+        std::optional<std::chrono::steady_clock::time_point> deadline;
+        // generation stops when all targets which are set are reached, share of cells covered by
+        // words (0 - 1) and number of words
+        double targetDensity = 0;
+        size_t targetWords = 0;
     };
 
+    struct GenerationResult
+    {
+        Board board;
+        Words words;
+        // targets were reached, without targets generation finished before time ran out
+        bool targetReached = false;
+        bool timedOut = false;
+    };
+
+    // Place words until targets are reached or time runs out, board reached so far is returned
+    // in either case. Time is checked between placement attempts and between setup stages, so it
+    // can be exceeded by one attempt or one stage. Slowest stage is building candidate table of
+    // board size used for the first time (hundreds of ms for 200x200), warm it up front when
+    // budget is short (see GetCandidateTable).
+    GenerationResult PositionWords(Random::Generator& generator, const Dictionary::Data& data, size_t boardRows, size_t boardCols,
+        size_t wordSizeFrom, size_t wordSizeTo, const GenerationLimits& limits, const PlacementPolicy& policy = {}, Stats* stats = nullptr);
+
+    // Letters encoded by alphabet are decoded.
+    void PrintBoard(const Board& board, const Dictionary::Alphabet* alphabet = nullptr);
+
+    size_t GetFreeCellsCount(const Board& board);
+
+    static constexpr size_t MAX_FILL_LETTERS = 64;
+
+    // Letters written to free cells (at most MAX_FILL_LETTERS) and their relative weights.
+    struct LetterDistribution
+    {
+        std::vector<uint8_t> letters;
+        std::vector<uint64_t> weights;
+    };
+
+    // Letters 'a' - 'z' with equal weights.
+    LetterDistribution GetLatinLetters();
+    // Letters of dictionary weighted by their frequency, e.g. codes of Dictionary::Alphabet.
+    // Only most frequent MAX_FILL_LETTERS are used.
+    LetterDistribution GetLetterDistribution(const Dictionary::Data& data);
+    // Counts stored in compiled dictionary (see MappedDictionary) save counting all letters.
+    LetterDistribution GetLetterDistribution(const Dictionary::LetterCounts& counts);
+
+    // Fill empty cells with random letters which do not create another occurrence of any word.
+    // Return cells for which no such letter exists, these are left empty. Letters are 'a' - 'z'
+    // with equal weights if not given.
+    std::vector<std::tuple<size_t, size_t>> FillFreeCellsRandom(Random::Generator& generator, Board& board, const Words& words, Stats* stats = nullptr);
+    std::vector<std::tuple<size_t, size_t>> FillFreeCellsRandom(Random::Generator& generator, Board& board, const Words& words, const LetterDistribution& letters, Stats* stats = nullptr);
+
+    // detail
+
     struct Candidate
     {
         int row;
@@ -42,4 +157,9 @@ namespace WordSearch
         Direction dir;
     };
     using Candidates = std::array<std::vector<Candidate>, Dictionary::MAX_WORD_SIZE>;
+
+    inline SpanMatch MatchWord(const Board& board, const Candidate& position, const WordPattern& word)
+    {
+        return word.Match(board.Span(position.row, position.col, position.dir));
+    }
 }